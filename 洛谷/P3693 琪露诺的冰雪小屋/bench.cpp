@@ -0,0 +1,197 @@
+// 命令流基准：四类随机脚本各跑若干局，按命令统计耗时，输出 JSON 报告
+// 用法：./bench [种子] [每类局数] > report.json
+// 编译：g++ -std=c++20 -O2 -DNDEBUG bench.cpp -o bench
+
+#define WORLD_NO_MAIN
+#define WORLD_PROFILE
+#include "main.cpp"
+
+#include <random>
+#include <string>
+
+namespace {
+
+// 生成一局合法的输入
+class ScriptGenerator {
+private:
+  std::mt19937_64 rng;
+  int n, hm, hr, hc, hx, hy;
+  std::vector<std::string> cmds;
+
+  int rand(int lo, int hi) {
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+  }
+
+  bool chance(double p) { return std::uniform_real_distribution<>()(rng) < p; }
+
+  void barrage(int r, int c, int d, int s) {
+    cmds.push_back("ICE_BARRAGE " + std::to_string(r) + ' ' +
+                   std::to_string(c) + ' ' + std::to_string(d) + ' ' +
+                   std::to_string(s));
+  }
+
+  void randomBarrage() {
+    barrage(rand(0, n - 1), rand(0, n - 1), rand(0, 7), rand(0, n));
+  }
+
+  void make() { cmds.push_back("MAKE_ICE_BLOCK"); }
+
+  void put(int r, int c, int h) {
+    cmds.push_back("PUT_ICE_BLOCK " + std::to_string(r) + ' ' +
+                   std::to_string(c) + ' ' + std::to_string(h));
+  }
+
+  void remove(int r, int c, int h) {
+    cmds.push_back("REMOVE_ICE_BLOCK " + std::to_string(r) + ' ' +
+                   std::to_string(c) + ' ' + std::to_string(h));
+  }
+
+  // 把整张图冻满 rounds 次，攒下 rounds * n^2 块冰砖
+  void stock(int rounds) {
+    for (int k = 0; k < rounds; ++k) {
+      for (int r = 0; r < n; ++r) {
+        for (int i = 0; i < 4; ++i)
+          barrage(r, 0, 6, n);
+      }
+      make();
+    }
+  }
+
+  // 墙上第 k 个格子，从 (hr, hc) 起顺时针编号，共 2 (hx + hy) - 4 个
+  std::pair<int, int> perimeterCell(int k) const {
+    if (k < hy)
+      return {hr, hc + k};
+    if (k < hx + hy - 1)
+      return {hr + k - hy + 1, hc + hy - 1};
+    if (k < hx + 2 * hy - 2)
+      return {hr + hx - 1, hc + hx + 2 * hy - 3 - k};
+    return {hr + 2 * hx + 2 * hy - 4 - k, hc};
+  }
+
+  void wall(int layers, double density) {
+    for (int k = 0; k < layers; ++k) {
+      for (int i = hr; i < hr + hx; ++i) {
+        for (int j = hc; j < hc + hy; ++j) {
+          const bool onWall =
+              i == hr || i == hr + hx - 1 || j == hc || j == hc + hy - 1;
+          if (onWall && chance(density))
+            put(i, j, k);
+        }
+      }
+    }
+  }
+
+public:
+  explicit ScriptGenerator(std::uint64_t seed) : rng(seed) {
+    n = rand(4, 16);
+    hm = rand(5, 20);
+    hx = rand(3, n);
+    hy = rand(3, n);
+    hr = rand(0, n - hx);
+    hc = rand(0, n - hy);
+  }
+
+  void barrageHeavy() {
+    while (cmds.size() < 999) {
+      const int t = rand(0, 19);
+      if (t < 17)
+        randomBarrage();
+      else if (t < 19)
+        make();
+      else
+        put(rand(0, n - 1), rand(0, n - 1), 0);
+    }
+  }
+
+  void buildHeavy() {
+    stock(2);
+    while (cmds.size() < 999) {
+      wall(rand(2, hm - 1), 0.95);
+      for (int i = rand(0, 20); i--;)
+        put(rand(0, n - 1), rand(0, n - 1), rand(0, hm - 1));
+    }
+    cmds.resize(999);
+  }
+
+  // 砌高墙、立柱子，再从底下拆，制造大面积坍塌
+  void collapseHeavy() {
+    stock(2);
+    while (cmds.size() < 999) {
+      wall(rand(3, hm - 1), 1);
+      for (int i = rand(1, 4); i--;) {
+        const int r = rand(0, n - 1), c = rand(0, n - 1);
+        for (int h = 0, t = rand(2, hm - 1); h < t; ++h)
+          put(r, c, h);
+        remove(r, c, rand(0, 1));
+      }
+      for (int i = rand(1, 8); i--;)
+        remove(rand(hr, hr + hx - 1), rand(hc, hc + hy - 1), rand(0, 1));
+    }
+    cmds.resize(999);
+  }
+
+  // 短局，每局都以一次完整的 MAKE_ROOF 收尾
+  void roofHeavy() {
+    stock(1);
+    wall(rand(1, 4), 0.97);
+    if (chance(0.8)) {
+      const auto door = perimeterCell(rand(0, 2 * (hx + hy) - 5));
+      remove(door.first, door.second, 0);
+      remove(door.first, door.second, 1);
+    }
+    for (int i = rand(0, 3); i--;)
+      put(rand(0, n - 1), rand(0, n - 1), rand(0, hm - 1));
+    while (cmds.size() < 9)
+      make();
+    cmds.resize(std::min<std::size_t>(cmds.size(), 999));
+  }
+
+  std::string finish() {
+    cmds.push_back("MAKE_ROOF");
+    std::string script = std::to_string(n) + ' ' + std::to_string(hm) + '\n' +
+                         std::to_string(hr) + ' ' + std::to_string(hc) + ' ' +
+                         std::to_string(hx) + ' ' + std::to_string(hy) + '\n' +
+                         std::to_string(cmds.size()) + '\n';
+    for (const std::string &cmd : cmds)
+      script += cmd + '\n';
+    return script;
+  }
+};
+
+struct Mix {
+  const char *name;
+  void (ScriptGenerator::*generate)();
+};
+
+constexpr Mix MIXES[] = {{"barrage", &ScriptGenerator::barrageHeavy},
+                         {"build", &ScriptGenerator::buildHeavy},
+                         {"collapse", &ScriptGenerator::collapseHeavy},
+                         {"roof", &ScriptGenerator::roofHeavy}};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::uint64_t seed = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1;
+  const int sessions = argc > 2 ? std::atoi(argv[2]) : 200;
+  Writer silent(nullptr);
+  std::printf("{\"seed\": %llu, \"sessions\": %d, \"mixes\": {",
+              static_cast<unsigned long long>(seed), sessions);
+  for (std::size_t k = 0; k < std::size(MIXES); ++k) {
+    commandProfile.clear();
+    std::uint64_t commands = 0;
+    for (int i = 0; i < sessions; ++i) {
+      ScriptGenerator generator(seed * 1000003 + k * 1009 + i);
+      (generator.*MIXES[k].generate)();
+      const std::string script = generator.finish();
+      Reader in(script);
+      run(in, silent);
+      commands += std::count(script.begin(), script.end(), '\n') - 3;
+    }
+    std::printf("%s\"%s\": {\"commands\": %llu, \"profile\": ", k ? ", " : "",
+                MIXES[k].name, static_cast<unsigned long long>(commands));
+    commandProfile.report(stdout);
+    std::fputc('}', stdout);
+  }
+  std::puts("}}");
+  return 0;
+}
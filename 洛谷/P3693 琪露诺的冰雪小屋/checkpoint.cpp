@@ -0,0 +1,79 @@
+// 检查点工具
+//   ./checkpoint save FILE < 输入      输入格式同 main.cpp，但不要求以 MAKE_ROOF 结尾
+//                                      执行完所有命令后把世界存到 FILE
+//   ./checkpoint resume FILE [OUT] < 输入
+//                                      输入只有 m 和 m 条命令，接着 FILE 继续执行
+//                                      给出 OUT 时把结束时的世界存到 OUT
+// 编译：g++ -std=c++20 -O2 -DWORLD_LARGE checkpoint.cpp -o checkpoint
+
+#define WORLD_NO_MAIN
+#include "main.cpp"
+#include "checkpoint.hpp"
+
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+void runCommands(World &world, Reader &in) {
+  for (int m = in.integer(); m--;) {
+    const Opcode opcode = parseOpcode(in.token());
+    runCommand(world, opcode, in);
+    if (opcode == Opcode::MAKE_ROOF)
+      break;
+  }
+}
+
+bool save(const World &world, const char *path) {
+  std::FILE *file = std::fopen(path, "wb");
+  if (!file)
+    return false;
+  const bool ok = world.saveCheckpoint(file);
+  return std::fclose(file) == 0 && ok;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    std::fputs("usage: checkpoint save FILE | resume FILE [OUT]\n", stderr);
+    return 2;
+  }
+  Reader in(stdin);
+  Writer out(stdout);
+  if (std::strcmp(argv[1], "save") == 0) {
+    const int n = in.integer(), hm = in.integer();
+    const int hr = in.integer(), hc = in.integer();
+    const int hx = in.integer(), hy = in.integer();
+    World world(n, hm, hr, hc, hx, hy, out);
+    runCommands(world, in);
+    if (!save(world, argv[2])) {
+      std::perror(argv[2]);
+      return 1;
+    }
+    return 0;
+  }
+  if (std::strcmp(argv[1], "resume") == 0) {
+    Writer silent(nullptr);
+    World world(4, 5, 0, 0, 1, 1, silent);
+    MappedCheckpoint checkpoint(argv[2]);
+    const auto start = std::chrono::steady_clock::now();
+    if (!checkpoint.attach(world)) {
+      std::fprintf(stderr, "%s: not a valid checkpoint\n", argv[2]);
+      return 1;
+    }
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    std::fprintf(stderr, "attached %s in %lld us\n", argv[2],
+                 static_cast<long long>(us.count()));
+    world.setOutput(out);
+    runCommands(world, in);
+    if (argc > 3 && !save(world, argv[3])) {
+      std::perror(argv[3]);
+      return 1;
+    }
+    return 0;
+  }
+  std::fprintf(stderr, "unknown mode %s\n", argv[1]);
+  return 2;
+}
@@ -0,0 +1,41 @@
+// 把检查点文件 mmap 进来，World 直接在映射上运行（POSIX，仅供离线工具）
+// 映射是 MAP_PRIVATE 的：之后的修改只在本进程可见，不会写回文件
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class MappedCheckpoint {
+private:
+  void *data = MAP_FAILED;
+  std::size_t size = 0;
+
+public:
+  explicit MappedCheckpoint(const char *path) {
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      size = st.st_size;
+      data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+  }
+
+  MappedCheckpoint(const MappedCheckpoint &) = delete;
+  MappedCheckpoint &operator=(const MappedCheckpoint &) = delete;
+
+  ~MappedCheckpoint() {
+    if (data != MAP_FAILED)
+      munmap(data, size);
+  }
+
+  // world 在映射的生命周期内有效
+  bool attach(World &world) {
+    return data != MAP_FAILED && world.attachCheckpoint(data, size);
+  }
+};
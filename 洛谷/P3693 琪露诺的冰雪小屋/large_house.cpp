@@ -0,0 +1,101 @@
+// WORLD_LARGE 的大房子：房子内部的体积和冰砖数都超过 int
+// 用命令攒出这么多冰砖太慢，直接在内存里拼一个检查点：
+// 整张图就是房子，墙砌到 hm - 1 层，上边正中开一个完整的门，冰砖够建屋顶
+// attach 之后 MAKE_ROOF，输出应当和手算的一致（见 expected）
+// 用法：./large_house [n]，n 默认 8400，此时 (n - 2)^2 * hm 超过 2^31
+//       一致时退出码为 0；n = 8400 时约占 1 GB 内存
+// 编译：g++ -std=c++20 -O2 -DWORLD_LARGE large_house.cpp -o large_house
+
+#define WORLD_NO_MAIN
+#include "main.cpp"
+
+#include <string>
+
+namespace {
+
+constexpr int HM = 31;
+constexpr std::int64_t LEFT = 3000000000; // 建完之后剩下的冰砖，超过 int
+
+// 墙上每一格都有 [0, HM) 层，门在上边的 (0, n / 2)，挨不着角
+std::vector<std::uint64_t> makeCheckpoint(int n) {
+  World::CheckpointHeader header = World::getCheckpointLayout(n);
+  header.hm = HM;
+  header.hr = header.hc = 0;
+  header.hx = header.hy = n;
+  header.blockCnt = std::int64_t(n) * n + LEFT;
+  std::vector<std::uint64_t> data((header.size + 7) / 8, 0);
+  char *bytes = reinterpret_cast<char *>(data.data());
+  std::copy_n(reinterpret_cast<const char *>(&header), sizeof(header), bytes);
+  std::uint32_t *columns =
+      reinterpret_cast<std::uint32_t *>(bytes + header.columnsOffset);
+  const std::uint32_t wall = (std::uint32_t(1) << HM) - 1;
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      if (i == 0 || i == n - 1 || j == 0 || j == n - 1)
+        columns[std::size_t(i) * n + j] = wall;
+    }
+  }
+  columns[n / 2] &= ~std::uint32_t(3);
+  return data;
+}
+
+// 屋顶在第 HM 层，没有要移除的冰砖，墙和四角都是好的，门在正中
+std::string expected() {
+  return "0 ICE_BLOCK(S) INSIDE THE HOUSE NEED TO BE REMOVED\n"
+         "0 ICE_BLOCK(S) OUTSIDE THE HOUSE NEED TO BE REMOVED\n"
+         "GOOD JOB CIRNO,SUCCESSFULLY BUILT THE HOUSE\n"
+         "DOOR IS OK\n"
+         "WALL IS OK\n"
+         "CORNER IS OK\n"
+         "CIRNO FINALLY HAS " +
+         std::to_string(LEFT) +
+         " ICE_BLOCK(S)\n"
+         "CIRNO IS PERFECT!\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const int n = argc > 1 ? std::atoi(argv[1]) : 8400;
+  if (!World::isValidShape(n, HM, 0, 0, n, n)) {
+    std::fprintf(stderr, "n = %d is out of range\n", n);
+    return 2;
+  }
+  std::vector<std::uint64_t> data = makeCheckpoint(n);
+  std::string evaluated, built;
+  Writer silent(nullptr);
+  World world(4, 5, 0, 0, 1, 1, silent);
+  if (!world.attachCheckpoint(data.data(), data.size() * 8)) {
+    std::fputs("checkpoint rejected\n", stderr);
+    return 1;
+  }
+  {
+    Writer out(evaluated);
+    world.setOutput(out);
+    world.printRoofReport(world.evaluateRoof());
+  }
+  {
+    Writer out(built);
+    world.setOutput(out);
+    world.makeRoof();
+  }
+  world.setOutput(silent);
+  const std::string expect = expected();
+  bool ok = true;
+  for (const std::string *got : {&evaluated, &built}) {
+    if (*got != expect) {
+      std::fprintf(stderr, "%s MAKE_ROOF:\n%sexpected:\n%s",
+                   got == &evaluated ? "evaluated" : "built", got->c_str(),
+                   expect.c_str());
+      ok = false;
+    }
+  }
+  if (world.getBlockCnt() != LEFT) {
+    std::fprintf(stderr, "block count %lld, expected %lld\n",
+                 static_cast<long long>(world.getBlockCnt()),
+                 static_cast<long long>(LEFT));
+    ok = false;
+  }
+  std::puts(ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
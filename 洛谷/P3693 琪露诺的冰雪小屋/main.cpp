@@ -3,21 +3,287 @@
 #endif
 
 #include <cassert>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 
+#include <algorithm>
 #include <initializer_list>
-#include <iostream>
+#include <limits>
 #include <queue>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 #include <vector>
 
+// 快速读入：一次性读入整个 stdin，之后在缓冲区上原地解析
+// 也可以直接解析一段现成的文本（不拷贝，调用者保证其有效）
+class Reader {
+private:
+  std::vector<char> buffer;
+  const char *ptr, *end;
+  bool bad = false; // 读到过超出 int 范围的整数
+
+  void skipSpaces() {
+    while (ptr != end && static_cast<unsigned char>(*ptr) <= ' ')
+      ++ptr;
+  }
+
+public:
+  explicit Reader(std::FILE *file) {
+    constexpr std::size_t CHUNK = 1 << 16;
+    std::size_t size = 0;
+    for (;;) {
+      buffer.resize(size + CHUNK);
+      const std::size_t cnt = std::fread(buffer.data() + size, 1, CHUNK, file);
+      size += cnt;
+      if (cnt < CHUNK)
+        break;
+    }
+    buffer.resize(size);
+    ptr = buffer.data();
+    end = ptr + size;
+  }
+
+  explicit Reader(std::string_view text)
+      : ptr(text.data()), end(text.data() + text.size()) {}
+
+  // 下一个以空白分隔的记号，不拷贝
+  std::string_view token() {
+    skipSpaces();
+    const char *begin = ptr;
+    while (ptr != end && static_cast<unsigned char>(*ptr) > ' ')
+      ++ptr;
+    return {begin, static_cast<std::size_t>(ptr - begin)};
+  }
+
+  // 超出 int 范围时返回 0，并且之后 good() 为 false
+  // 在 uint64 里累加，超过上界就不再增长，数字再长也不会溢出
+  int integer() {
+    skipSpaces();
+    bool negative = false;
+    if (ptr != end && *ptr == '-') {
+      negative = true;
+      ++ptr;
+    }
+    const std::uint64_t limit =
+        std::uint64_t(std::numeric_limits<int>::max()) + negative;
+    std::uint64_t x = 0;
+    while (ptr != end && *ptr >= '0' && *ptr <= '9')
+      x = std::min(x * 10 + (*ptr++ - '0'), limit + 1);
+    if (x > limit) {
+      bad = true;
+      return 0;
+    }
+    return static_cast<int>(negative ? -std::int64_t(x) : std::int64_t(x));
+  }
+
+  // 目前为止读到的整数是否都在 int 范围内
+  // 题目的输入总是在范围内，只有 server 这样接收外部输入的工具需要检查
+  bool good() const { return !bad; }
+};
+
+// 缓冲输出：攒满一整块再写出
+// 写到文件或追加到字符串；file 为空时丢弃所有输出
+class Writer {
+private:
+  static constexpr std::size_t CAPACITY = 1 << 16;
+  std::FILE *file = nullptr;
+  std::string *target = nullptr;
+  char buffer[CAPACITY];
+  std::size_t size = 0;
+
+  void write(const char *data, std::size_t len) {
+    if (file)
+      std::fwrite(data, 1, len, file);
+    else if (target)
+      target->append(data, len);
+  }
+
+public:
+  explicit Writer(std::FILE *file) : file(file) {}
+  explicit Writer(std::string &target) : target(&target) {}
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+  ~Writer() { flush(); }
+
+  void flush() {
+    write(buffer, size);
+    size = 0;
+  }
+
+  Writer &operator<<(char ch) {
+    if (size == CAPACITY)
+      flush();
+    buffer[size++] = ch;
+    return *this;
+  }
+
+  Writer &operator<<(std::string_view str) {
+    if (size + str.size() > CAPACITY) {
+      flush();
+      if (str.size() > CAPACITY) {
+        write(str.data(), str.size());
+        return *this;
+      }
+    }
+    for (char ch : str)
+      buffer[size++] = ch;
+    return *this;
+  }
+
+  Writer &operator<<(const char *str) { return *this << std::string_view(str); }
+
+  Writer &operator<<(int x) { return *this << std::int64_t(x); }
+
+  Writer &operator<<(std::int64_t x) {
+    char digits[20];
+    int len = 0;
+    std::uint64_t y = x < 0 ? 0 - static_cast<std::uint64_t>(x)
+                            : static_cast<std::uint64_t>(x);
+    do {
+      digits[len++] = static_cast<char>('0' + y % 10);
+      y /= 10;
+    } while (y);
+    if (x < 0)
+      digits[len++] = '-';
+    if (size + len > CAPACITY)
+      flush();
+    while (len)
+      buffer[size++] = digits[--len];
+    return *this;
+  }
+};
+
+enum class Opcode {
+  ICE_BARRAGE,
+  MAKE_ICE_BLOCK,
+  PUT_ICE_BLOCK,
+  REMOVE_ICE_BLOCK,
+  MAKE_ROOF,
+  UNKNOWN
+};
+
+// FNV-1a
+constexpr std::uint32_t hashToken(std::string_view str) {
+  std::uint32_t h = 2166136261U;
+  for (char ch : str) {
+    h ^= static_cast<unsigned char>(ch);
+    h *= 16777619U;
+  }
+  return h;
+}
+
+// 操作名 -> Opcode，先比哈希再确认一次全串
+Opcode parseOpcode(std::string_view token) {
+  Opcode opcode;
+  std::string_view name;
+  switch (hashToken(token)) {
+  case hashToken("ICE_BARRAGE"):
+    opcode = Opcode::ICE_BARRAGE, name = "ICE_BARRAGE";
+    break;
+  case hashToken("MAKE_ICE_BLOCK"):
+    opcode = Opcode::MAKE_ICE_BLOCK, name = "MAKE_ICE_BLOCK";
+    break;
+  case hashToken("PUT_ICE_BLOCK"):
+    opcode = Opcode::PUT_ICE_BLOCK, name = "PUT_ICE_BLOCK";
+    break;
+  case hashToken("REMOVE_ICE_BLOCK"):
+    opcode = Opcode::REMOVE_ICE_BLOCK, name = "REMOVE_ICE_BLOCK";
+    break;
+  case hashToken("MAKE_ROOF"):
+    opcode = Opcode::MAKE_ROOF, name = "MAKE_ROOF";
+    break;
+  default:
+    return Opcode::UNKNOWN;
+  }
+  return token == name ? opcode : Opcode::UNKNOWN;
+}
+
+// 一段连续存储：自己持有，或者借用外部的内存（比如 mmap 进来的检查点）
+// 复制时总是深拷贝成自己持有的
+template <class T> class Buffer {
+private:
+  std::vector<T> owned;
+  T *ptr = nullptr;
+  std::size_t len = 0;
+
+public:
+  Buffer() = default;
+  Buffer(const Buffer &other)
+      : owned(other.ptr, other.ptr + other.len), ptr(owned.data()),
+        len(other.len) {}
+  Buffer(Buffer &&other) noexcept { *this = std::move(other); }
+
+  Buffer &operator=(const Buffer &other) {
+    if (this != &other) {
+      owned.assign(other.ptr, other.ptr + other.len);
+      ptr = owned.data();
+      len = other.len;
+    }
+    return *this;
+  }
+
+  Buffer &operator=(Buffer &&other) noexcept {
+    const bool borrowed = other.ptr != other.owned.data();
+    owned = std::move(other.owned);
+    ptr = borrowed ? other.ptr : owned.data();
+    len = other.len;
+    other.ptr = nullptr;
+    other.len = 0;
+    return *this;
+  }
+
+  // 改为自己持有，尽量复用已有容量
+  void assign(std::size_t count, const T &val) {
+    owned.assign(count, val);
+    ptr = owned.data();
+    len = count;
+  }
+
+  void borrow(T *data, std::size_t count) {
+    owned.clear();
+    ptr = data;
+    len = count;
+  }
+
+  T &operator[](std::size_t pos) { return ptr[pos]; }
+  const T &operator[](std::size_t pos) const { return ptr[pos]; }
+  T *data() { return ptr; }
+  const T *data() const { return ptr; }
+  std::size_t size() const { return len; }
+};
+
 class World {
 private:
   int n, hm, hr, hc, hx, hy;
-  std::vector<std::vector<int>> coldness;               // 冷冻度
-  std::vector<std::vector<std::vector<bool>>> hasBlock; // 是否有冰砖
-  int blockCnt;                                         // 当前冰砖数
+  Buffer<unsigned char> coldness; // 冷冻度，按行展开
+  Buffer<std::uint32_t> columns;  // 每格一列，第 h 位表示高度 h 有冰砖
+  std::int64_t blockCnt;          // 当前冰砖数
+  Writer *out;                    // 输出
+
+  // 撤销日志，只在存在未释放的快照时记录，每条记下被改动前的值
+  struct JournalEntry {
+    enum class Kind { COLDNESS, BLOCK, BLOCK_CNT } kind;
+    int r, c, h;
+    std::int64_t old;
+  };
+  std::vector<JournalEntry> journal;
+  int snapshotCnt = 0; // 未释放的快照数
+
+public:
+  // 性能计数，只增不减；只有修改世界的命令会计数，
+  // const 的试算不碰它，多个线程可以同时试算同一个世界
+  struct Stats {
+    std::uint64_t danglingCalls = 0;   // removeDanglingIceBlocks 调用次数
+    std::uint64_t danglingVisited = 0; // 其中 BFS 访问的冰砖数
+    std::uint64_t danglingRemoved = 0; // 其中清除的悬空冰砖数
+    std::uint64_t fieldScans = 0;      // countInFieldBlocks 调用次数
+  };
+
+private:
+  Stats stats;
 
   static constexpr int delta1[8][2] = {{-1, 0}, {-1, -1}, {0, -1},
                                        {1, -1}, {1, 0},   {1, 1},
@@ -26,6 +292,10 @@ private:
                                        {0, -1, 0}, {0, 1, 0},
                                        {0, 0, -1}, {0, 0, 1}}; // 立体
 
+  bool hasBlock(int r, int c, int h) const {
+    return columns[r * n + c] >> h & 1;
+  }
+
   bool inRange(int r, int c, int h) const {
     return r >= 0 && r < n && c >= 0 && c < n && h >= 0 && h <= hm;
   }
@@ -36,84 +306,120 @@ private:
       const int _r = r + delta2[i][0];
       const int _c = c + delta2[i][1];
       const int _h = h + delta2[i][2];
-      if (inRange(_r, _c, _h) && hasBlock[_r][_c][_h])
+      if (inRange(_r, _c, _h) && hasBlock(_r, _c, _h))
         return true;
     }
     return false;
   }
 
-  // 当前已放置冰砖个数
-  int countInFieldBlocks() const {
-    int cnt = 0;
-    for (int i = 0; i < n; ++i) {
-      for (int j = 0; j < n; ++j) {
-        for (int k = 0; k <= hm; ++k) {
-          if (hasBlock[i][j][k])
-            ++cnt;
-        }
-      }
-    }
+  // 所有对 coldness / hasBlock / blockCnt 的修改都走下面三个函数
+  void setColdness(int r, int c, int val) {
+    if (snapshotCnt)
+      journal.push_back(
+          {JournalEntry::Kind::COLDNESS, r, c, 0, coldness[r * n + c]});
+    coldness[r * n + c] = val;
+  }
+
+  void setBlock(int r, int c, int h, bool val) {
+    if (snapshotCnt)
+      journal.push_back(
+          {JournalEntry::Kind::BLOCK, r, c, h, hasBlock(r, c, h)});
+    if (val)
+      columns[r * n + c] |= std::uint32_t(1) << h;
+    else
+      columns[r * n + c] &= ~(std::uint32_t(1) << h);
+  }
+
+  void setBlockCnt(std::int64_t val) {
+    if (snapshotCnt)
+      journal.push_back({JournalEntry::Kind::BLOCK_CNT, 0, 0, 0, blockCnt});
+    blockCnt = val;
+  }
+
+  // 当前已放置冰砖个数，不计入 stats
+  std::int64_t peekInFieldBlocks() const {
+    std::int64_t cnt = 0;
+    for (std::size_t i = 0; i < columns.size(); ++i)
+      cnt += __builtin_popcount(columns[i]);
     return cnt;
   }
 
+  std::int64_t countInFieldBlocks() {
+    ++stats.fieldScans;
+    return peekInFieldBlocks();
+  }
+
   // 移除所有悬空的冰砖
+  // 只清除真正悬空的格子，这样撤销日志里只有实际变化
   void removeDanglingIceBlocks() {
-    std::vector<std::vector<std::vector<bool>>> hasBlockNew(
-        n, std::vector<std::vector<bool>>(n, std::vector<bool>(hm + 1, false)));
+    ++stats.danglingCalls;
+    std::vector<std::uint32_t> reached(n * n, 0);
     std::queue<std::tuple<int, int, int>> queue;
     for (int i = 0; i < n; ++i) {
       for (int j = 0; j < n; ++j) {
-        if (hasBlock[i][j][0]) {
+        if (hasBlock(i, j, 0)) {
           queue.emplace(i, j, 0);
-          hasBlock[i][j][0] = false;
+          reached[i * n + j] |= 1;
         }
       }
     }
     while (!queue.empty()) {
       const auto [r, c, h] = queue.front();
       queue.pop();
-      hasBlockNew[r][c][h] = true;
+      ++stats.danglingVisited;
       for (int i = 0; i < 6; ++i) {
         const int _r = r + delta2[i][0];
         const int _c = c + delta2[i][1];
         const int _h = h + delta2[i][2];
-        if (inRange(_r, _c, _h) && hasBlock[_r][_c][_h]) {
+        if (inRange(_r, _c, _h) && hasBlock(_r, _c, _h) &&
+            !(reached[_r * n + _c] >> _h & 1)) {
           queue.emplace(_r, _c, _h);
-          hasBlock[_r][_c][_h] = false;
+          reached[_r * n + _c] |= std::uint32_t(1) << _h;
+        }
+      }
+    }
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+        for (int k = 0; k <= hm; ++k) {
+          if (hasBlock(i, j, k) && !(reached[i * n + j] >> k & 1)) {
+            ++stats.danglingRemoved;
+            setBlock(i, j, k, false);
+          }
         }
       }
     }
-    hasBlock = std::move(hasBlockNew);
   }
 
   // 计算屋顶所在高度
-  int getRoofHeight() const {
+  int getRoofHeight(int hr, int hc, int hx, int hy) const {
     for (int i = hm - 1; i >= 0; --i) {
       for (int j = hr; j < hr + hx; ++j) {
-        if (hasBlock[j][hc][i] || hasBlock[j][hc + hy - 1][i])
+        if (hasBlock(j, hc, i) || hasBlock(j, hc + hy - 1, i))
           return i + 1;
       }
       for (int j = hc; j < hc + hy; ++j) {
-        if (hasBlock[hr][j][i] || hasBlock[hr + hx - 1][j][i])
+        if (hasBlock(hr, j, i) || hasBlock(hr + hx - 1, j, i))
           return i + 1;
       }
     }
     return 0;
   }
 
+  int getRoofHeight() const { return getRoofHeight(hr, hc, hx, hy); }
+
   // [r1, r2] 行，[c1, c2] 列，高度 [h1, h2]  冰砖数
-  int countBlocksInRange(int r1, int r2, int c1, int c2, int h1, int h2) {
-    int cnt = 0;
+  std::int64_t countBlocksInRange(int r1, int r2, int c1, int c2, int h1,
+                                  int h2) const {
+    std::int64_t cnt = 0;
     assert(0 <= r1 && r1 <= r2 && r2 < n);
     assert(0 <= c1 && c1 <= c2 && c2 < n);
     assert(0 <= h1 && h1 <= h2 && h2 <= hm);
+    const std::uint32_t mask =
+        static_cast<std::uint32_t>((std::uint64_t(1) << (h2 + 1)) -
+                                   (std::uint64_t(1) << h1));
     for (int i = r1; i <= r2; ++i) {
-      for (int j = c1; j <= c2; ++j) {
-        for (int k = h1; k <= h2; ++k) {
-          if (hasBlock[i][j][k])
-            ++cnt;
-        }
-      }
+      for (int j = c1; j <= c2; ++j)
+        cnt += __builtin_popcount(columns[i * n + j] & mask);
     }
     return cnt;
   }
@@ -126,146 +432,404 @@ private:
     HAS_HALF_CORNER_DOOR
   };
 
+  // 周长模型：墙上的格子按顺时针编号，每层压成一个位图
+  // 门的判定都化成位运算，和房子多大无关
+  using Mask = std::vector<std::uint64_t>;
+
+  static bool testBit(const Mask &mask, int pos) {
+    return mask[pos >> 6] >> (pos & 63) & 1;
+  }
+
+  // 一个房子的位置和它的周长模型，建好之后只读
+  struct House {
+    struct CornerDoorCandidate {
+      int r, c;       // 角落门的位置
+      int pos;        // 在周长上的编号
+      int corners[4]; // 相邻的角在周长上的编号，1x1 时同一个角算四次
+      int cornerCnt;
+    };
+
+    int hr = 0, hc = 0, hx = 0, hy = 0;
+    std::vector<std::pair<int, int>> perimeter; // 编号 -> 坐标
+    Mask middleMask; // 可以开完整门（不挨着角）的位置
+    std::vector<CornerDoorCandidate> cornerDoors; // 按原来的枚举顺序
+
+    House() = default;
+
+    // 不到 3x3 的房子里只有 1x1 能走到开门的判定（(hx-2)(hy-2)h = h），
+    // 这时角落门的候选在房子外面；按原来的逐格判定，把房子里的格子
+    // 和这些候选都编上号，顺序无关紧要
+    House(int hr, int hc, int hx, int hy) : hr(hr), hc(hc), hx(hx), hy(hy) {
+      if (isRing()) {
+        for (int j = hc; j < hc + hy; ++j)
+          perimeter.emplace_back(hr, j);
+        for (int i = hr + 1; i < hr + hx; ++i)
+          perimeter.emplace_back(i, hc + hy - 1);
+        for (int j = hc + hy - 2; j >= hc; --j)
+          perimeter.emplace_back(hr + hx - 1, j);
+        for (int i = hr + hx - 2; i > hr; --i)
+          perimeter.emplace_back(i, hc);
+      } else {
+        for (int i = hr; i < hr + hx; ++i) {
+          for (int j = hc; j < hc + hy; ++j)
+            perimeter.emplace_back(i, j);
+        }
+      }
+      const auto addCornerDoor = [this](int r, int c) {
+        if (!isRing() && std::find(perimeter.begin(), perimeter.end(),
+                                   std::make_pair(r, c)) == perimeter.end())
+          perimeter.emplace_back(r, c);
+        CornerDoorCandidate candidate{r, c, perimeterIndex(r, c), {}, 0};
+        for (int i : {this->hr, this->hr + this->hx - 1}) {
+          for (int j : {this->hc, this->hc + this->hy - 1}) {
+            if (std::abs(r - i) + std::abs(c - j) == 1)
+              candidate.corners[candidate.cornerCnt++] = perimeterIndex(i, j);
+          }
+        }
+        cornerDoors.push_back(candidate);
+      };
+      for (int i : {hr + 1, hr + hx - 2}) {
+        for (int j : {hc, hc + hy - 1})
+          addCornerDoor(i, j);
+      }
+      for (int i : {hr, hr + hx - 1}) {
+        for (int j : {hc + 1, hc + hy - 2})
+          addCornerDoor(i, j);
+      }
+      middleMask.assign((perimeter.size() + 63) / 64, 0);
+      for (int i = hr + 2; i <= hr + hx - 3; ++i) {
+        for (int j : {hc, hc + hy - 1}) {
+          const int pos = perimeterIndex(i, j);
+          middleMask[pos >> 6] |= std::uint64_t(1) << (pos & 63);
+        }
+      }
+      for (int i = hc + 2; i <= hc + hy - 3; ++i) {
+        for (int j : {hr, hr + hx - 1}) {
+          const int pos = perimeterIndex(j, i);
+          middleMask[pos >> 6] |= std::uint64_t(1) << (pos & 63);
+        }
+      }
+    }
+
+    bool isRing() const { return hx >= 3 && hy >= 3; }
+
+    int perimeterIndex(int r, int c) const {
+      if (!isRing()) {
+        const auto it = std::find(perimeter.begin(), perimeter.end(),
+                                  std::make_pair(r, c));
+        assert(it != perimeter.end());
+        return static_cast<int>(it - perimeter.begin());
+      }
+      if (r == hr)
+        return c - hc;
+      if (c == hc + hy - 1)
+        return (hy - 1) + (r - hr);
+      if (r == hr + hx - 1)
+        return (hy - 1) + (hx - 1) + (hc + hy - 1 - c);
+      assert(c == hc);
+      return 2 * (hy - 1) + (hx - 1) + (hr + hx - 1 - r);
+    }
+
+    bool contains(int r, int c) const {
+      return r >= hr && r < hr + hx && c >= hc && c < hc + hy;
+    }
+
+    bool isWall(int r, int c) const {
+      return contains(r, c) &&
+             (r == hr || r == hr + hx - 1 || c == hc || c == hc + hy - 1);
+    }
+  };
+
+  House house;              // 本局的房子
+  std::vector<House> houses; // 额外登记的候选房子，只用来试算
+
   struct DoorInfo {
     DoorState doorState;
     int cornersNeedFix;
+    // 需要修复四角时：选中的角落门，以及要补的高度 [fixH1, fixH2]
+    const House::CornerDoorCandidate *fix = nullptr;
+    int fixH1 = 0, fixH2 = 0;
   };
 
-  // 计算门在对应位置时，需要修复的四角块数
-  // @param r,c 门的位置
-  // @param h1,h2 要修复的高度范围
-  int countNeedFixCornerForDoor(int r, int c, int h1, int h2) {
-    int cnt = 0;
-    for (int i : {hr, hr + hx - 1}) {
-      for (int j : {hc, hc + hy - 1}) {
-        assert(r != i || c != j);
-        if (std::abs(r - i) + std::abs(c - j) == 1)
-          cnt += h2 - h1 + 1 - countBlocksInRange(i, i, j, j, h1, h2);
-      }
+  // 第 h 层墙上空着的位置，has(r, c, h) 给出网格
+  template <class Has>
+  static Mask getEmptyMask(const House &target, int h, Has has) {
+    Mask mask(target.middleMask.size(), 0);
+    for (std::size_t i = 0; i < target.perimeter.size(); ++i) {
+      const auto [r, c] = target.perimeter[i];
+      if (!has(r, c, h))
+        mask[i >> 6] |= std::uint64_t(1) << (i & 63);
     }
-    return cnt;
+    return mask;
   }
 
-  // 修复四角
-  void fixCornerForDoor(int r, int c, int h1, int h2) {
-    for (int i : {hr, hr + hx - 1}) {
-      for (int j : {hc, hc + hy - 1}) {
+  // 修复四角：对门 (r, c) 相邻的每个角的 [h1, h2] 层调用 set(i, j, k)
+  template <class Set>
+  static void fixCornerForDoor(const House &target, int r, int c, int h1,
+                               int h2, Set set) {
+    for (int i : {target.hr, target.hr + target.hx - 1}) {
+      for (int j : {target.hc, target.hc + target.hy - 1}) {
         assert(r != i || c != j);
         if (std::abs(r - i) + std::abs(c - j) == 1) {
           for (int k = h1; k <= h2; ++k)
-            hasBlock[i][j][k] = true;
+            set(i, j, k);
         }
       }
     }
   }
 
-  // 计算门的状态
-  // 如果需要修复四角，顺便修复
-  DoorInfo getDoorState() {
-    { // 完整门
-      for (int i = hr + 2; i <= hr + hx - 3; ++i) {
-        for (int j : {hc, hc + hy - 1}) {
-          if (!hasBlock[i][j][0] && !hasBlock[i][j][1])
-            return {DoorState::HAS_DOOR, 0};
-        }
-      }
-      for (int i = hc + 2; i <= hc + hy - 3; ++i) {
-        for (int j : {hr, hr + hx - 1}) {
-          if (!hasBlock[j][i][0] && !hasBlock[j][i][1])
-            return {DoorState::HAS_DOOR, 0};
-        }
-      }
+  // 计算门的状态，只看第 0、1 层墙上的空位，不修改任何东西
+  static DoorInfo classifyDoor(const House &target, const Mask &empty0,
+                               const Mask &empty1) {
+    bool fullDoor = false, halfDoor = false;
+    for (std::size_t i = 0; i < target.middleMask.size(); ++i) {
+      fullDoor |= (empty0[i] & empty1[i] & target.middleMask[i]) != 0;
+      halfDoor |= ((empty0[i] | empty1[i]) & target.middleMask[i]) != 0;
     }
+    // 完整门
+    if (fullDoor)
+      return {DoorState::HAS_DOOR, 0};
     { // 完整角落门
-      int r, c, cnt = -1;
-      const auto check = [this, &r, &c, &cnt](int x, int y) {
-        const int t = countNeedFixCornerForDoor(x, y, 0, 1);
+      const House::CornerDoorCandidate *best = nullptr;
+      int cnt = -1;
+      for (const House::CornerDoorCandidate &door : target.cornerDoors) {
+        if (!testBit(empty0, door.pos) || !testBit(empty1, door.pos))
+          continue;
+        int t = 0;
+        for (int i = 0; i < door.cornerCnt; ++i)
+          t += testBit(empty0, door.corners[i]) +
+               testBit(empty1, door.corners[i]);
         if (cnt == -1 || t < cnt) {
           cnt = t;
-          r = x;
-          c = y;
-        }
-      };
-      for (int i : {hr + 1, hr + hx - 2}) {
-        for (int j : {hc, hc + hy - 1}) {
-          if (!hasBlock[i][j][0] && !hasBlock[i][j][1])
-            check(i, j);
-        }
-      }
-      for (int i : {hr, hr + hx - 1}) {
-        for (int j : {hc + 1, hc + hy - 2}) {
-          if (!hasBlock[i][j][0] && !hasBlock[i][j][1])
-            check(i, j);
-        }
-      }
-      if (cnt != -1) {
-        fixCornerForDoor(r, c, 0, 2);
-        return {DoorState::HAS_CORNER_DOOR, cnt};
-      }
-    }
-    { // 不完整门
-      for (int i = hr + 2; i <= hr + hx - 3; ++i) {
-        for (int j : {hc, hc + hy - 1}) {
-          if (!hasBlock[i][j][0] || !hasBlock[i][j][1])
-            return {DoorState::HAS_HALF_DOOR, 0};
-        }
-      }
-      for (int i = hc + 2; i <= hc + hy - 3; ++i) {
-        for (int j : {hr, hr + hx - 1}) {
-          if (!hasBlock[j][i][0] || !hasBlock[j][i][1])
-            return {DoorState::HAS_HALF_DOOR, 0};
+          best = &door;
         }
       }
+      if (best)
+        return {DoorState::HAS_CORNER_DOOR, cnt, best, 0, 2};
     }
+    // 不完整门
+    if (halfDoor)
+      return {DoorState::HAS_HALF_DOOR, 0};
     { // 不完整角落门
-      int r, c, cnt = -1;
-      const auto check = [this, &r, &c, &cnt](int x, int y) {
-        const int t = countNeedFixCornerForDoor(
-            x, y, !hasBlock[x][y][0] ? 0 : 1, !hasBlock[x][y][0] ? 0 : 1);
+      const House::CornerDoorCandidate *best = nullptr;
+      int cnt = -1, layer = 0;
+      for (const House::CornerDoorCandidate &door : target.cornerDoors) {
+        const bool open0 = testBit(empty0, door.pos);
+        if (!open0 && !testBit(empty1, door.pos))
+          continue;
+        const Mask &empty = open0 ? empty0 : empty1;
+        int t = 0;
+        for (int i = 0; i < door.cornerCnt; ++i)
+          t += testBit(empty, door.corners[i]);
         if (cnt == -1 || t < cnt) {
           cnt = t;
-          r = x;
-          c = y;
-        }
-      };
-      for (int i : {hr + 1, hr + hx - 2}) {
-        for (int j : {hc, hc + hy - 1}) {
-          if (!hasBlock[i][j][0] || !hasBlock[i][j][1])
-            check(i, j);
-        }
-      }
-      for (int i : {hr, hr + hx - 1}) {
-        for (int j : {hc + 1, hc + hy - 2}) {
-          if (!hasBlock[i][j][0] || !hasBlock[i][j][1])
-            check(i, j);
+          best = &door;
+          layer = open0 ? 0 : 1;
         }
       }
-      if (cnt != -1 && cnt <= 1) {
-        fixCornerForDoor(r, c, !hasBlock[r][c][0] ? 0 : 1,
-                         !hasBlock[r][c][0] ? 0 : 1);
-        return {DoorState::HAS_HALF_CORNER_DOOR, cnt};
-      }
+      if (best && cnt <= 1)
+        return {DoorState::HAS_HALF_CORNER_DOOR, cnt, best, layer, layer};
     }
     return {DoorState::NO_DOOR, 0};
   }
 
 public:
-  World(int n, int hm, int hr, int hc, int hx, int hy)
-      : n(n), hm(hm), hr(hr), hc(hc), hx(hx), hy(hy),
-        coldness(n, std::vector<int>(n, 0)),
-        hasBlock(n, std::vector<std::vector<bool>>(
-                        n, std::vector<bool>(hm + 1, false))),
-        blockCnt(0) {
-    assert(n >= 4 && n <= 16);
-    assert(hm >= 5 && hm <= 20);
-    assert(hr >= 0 && hr < n);
-    assert(hc >= 0 && hc < n);
-    assert(hx > 0 && hr + hx - 1 < n);
-    assert(hy > 0 && hc + hy - 1 < n);
+  // 题目的数据范围；WORLD_LARGE 下放开上界，只要求一列装得进 uint32，
+  // 并且格子的下标 r * n + c 和格子数 n * n 都放得下 int
+  // 冰砖数、房子的体积可以到 n * n * (hm + 1)，一律按 int64 算
+  static bool isValidShape(int n, int hm, int hr, int hc, int hx, int hy) {
+#ifdef WORLD_LARGE
+    if (n < 4 || n > 46340 || hm < 5 || hm > 31)
+      return false;
+#else
+    if (n < 4 || n > 16 || hm < 5 || hm > 20)
+      return false;
+#endif
+    return hr >= 0 && hr < n && hc >= 0 && hc < n && hx > 0 && hx <= n - hr &&
+           hy > 0 && hy <= n - hc;
+  }
+
+  World(int n, int hm, int hr, int hc, int hx, int hy, Writer &out)
+      : out(&out) {
+    reset(n, hm, hr, hc, hx, hy);
+  }
+
+  // 重新开一局，尽量复用已经分配的网格
+  void reset(int n, int hm, int hr, int hc, int hx, int hy) {
+    assert(isValidShape(n, hm, hr, hc, hx, hy));
+    this->n = n;
+    this->hm = hm;
+    this->hr = hr;
+    this->hc = hc;
+    this->hx = hx;
+    this->hy = hy;
+    coldness.assign(n * n, 0);
+    columns.assign(n * n, 0);
+    blockCnt = 0;
+    journal.clear();
+    snapshotCnt = 0;
+    stats = {};
+    house = House(hr, hc, hx, hy);
+    houses.clear();
+  }
+
+  int getColdness(int r, int c) const { return coldness[r * n + c]; }
+  std::int64_t getBlockCnt() const { return blockCnt; }
+  const Stats &getStats() const { return stats; }
+
+  // 命令的参数是否在范围内，和各命令开头的断言一致
+  // 题目保证输入合法，只有 server 这样接收外部输入的工具需要先检查
+  bool isValidShot(int r, int c, int d, int s) const {
+    return inRange(r, c, 0) && d >= 0 && d <= 7 && s >= 0 && s <= n;
+  }
+
+  bool isValidPut(int r, int c, int h) const {
+    return inRange(r, c, h) && h < hm;
+  }
+
+  bool isValidRemove(int r, int c, int h) const { return inRange(r, c, h); }
+
+  // 检查点：定长头部 + 冷冻度 + 冰砖列，各段按 8 字节对齐
+  // 布局就是 World 的内存布局，mmap 之后可以原地使用，不需要解析
+  struct CheckpointHeader {
+    char magic[8]; // "CIRNOWLD"
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::int32_t n, hm, hr, hc, hx, hy;
+    std::int64_t blockCnt; // 原来是 int32 加 4 字节保留，小端下旧文件照样能读
+    std::uint64_t coldnessOffset; // n * n 个 unsigned char
+    std::uint64_t columnsOffset;  // n * n 个 uint32，第 h 位表示高度 h
+    std::uint64_t size;           // 整个文件的字节数
+  };
+
+  static constexpr char CHECKPOINT_MAGIC[8] = {'C', 'I', 'R', 'N',
+                                               'O', 'W', 'L', 'D'};
+  static constexpr std::uint32_t CHECKPOINT_VERSION = 1;
+
+  // 只和 n 有关的部分：标识、各段偏移和总大小
+  static CheckpointHeader getCheckpointLayout(int n) {
+    CheckpointHeader header{};
+    std::copy(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC + 8, header.magic);
+    header.version = CHECKPOINT_VERSION;
+    header.headerSize = sizeof(CheckpointHeader);
+    header.n = n;
+    const auto align = [](std::uint64_t x) { return (x + 7) & ~7ULL; };
+    header.coldnessOffset = align(sizeof(CheckpointHeader));
+    header.columnsOffset =
+        align(header.coldnessOffset + std::uint64_t(n) * n);
+    header.size = header.columnsOffset + std::uint64_t(n) * n * 4;
+    return header;
+  }
+
+  bool saveCheckpoint(std::FILE *file) const {
+    CheckpointHeader header = getCheckpointLayout(n);
+    header.hm = hm;
+    header.hr = hr;
+    header.hc = hc;
+    header.hx = hx;
+    header.hy = hy;
+    header.blockCnt = blockCnt;
+    std::uint64_t written = 0;
+    const auto write = [file, &written](const void *data, std::uint64_t len) {
+      written += len;
+      return std::fwrite(data, 1, len, file) == len;
+    };
+    const auto pad = [&write, &written](std::uint64_t to) {
+      const char zeros[8] = {};
+      return write(zeros, to - written);
+    };
+    return write(&header, sizeof(header)) && pad(header.coldnessOffset) &&
+           write(coldness.data(), coldness.size()) &&
+           pad(header.columnsOffset) &&
+           write(columns.data(), columns.size() * 4);
+  }
+
+  // 直接在 data 处的检查点上继续运行，网格不拷贝
+  // data 须 8 字节对齐、可写，并在 World 存活期间保持有效
+  // 格式不对时返回 false，World 不变
+  bool attachCheckpoint(void *data, std::size_t size) {
+    CheckpointHeader header;
+    if (size < sizeof(header))
+      return false;
+    std::copy_n(static_cast<const char *>(data), sizeof(header),
+                reinterpret_cast<char *>(&header));
+    if (!std::equal(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC + 8, header.magic) ||
+        header.version != CHECKPOINT_VERSION ||
+        header.headerSize != sizeof(CheckpointHeader) ||
+        !isValidShape(header.n, header.hm, header.hr, header.hc, header.hx,
+                      header.hy))
+      return false;
+    const CheckpointHeader expected = getCheckpointLayout(header.n);
+    if (header.coldnessOffset != expected.coldnessOffset ||
+        header.columnsOffset != expected.columnsOffset ||
+        header.size != expected.size || size < header.size)
+      return false;
+    n = header.n;
+    hm = header.hm;
+    hr = header.hr;
+    hc = header.hc;
+    hx = header.hx;
+    hy = header.hy;
+    blockCnt = header.blockCnt;
+    char *bytes = static_cast<char *>(data);
+    coldness.borrow(
+        reinterpret_cast<unsigned char *>(bytes + header.coldnessOffset),
+        std::size_t(n) * n);
+    columns.borrow(
+        reinterpret_cast<std::uint32_t *>(bytes + header.columnsOffset),
+        std::size_t(n) * n);
+    journal.clear();
+    snapshotCnt = 0;
+    stats = {};
+    house = House(hr, hc, hx, hy);
+    houses.clear();
+    return true;
+  }
+
+  void setOutput(Writer &out) { this->out = &out; }
+
+  // 快照即当前日志长度；快照可以嵌套，代价只和之后的修改量有关
+  using Snapshot = std::size_t;
+
+  Snapshot snapshot() {
+    ++snapshotCnt;
+    return journal.size();
+  }
+
+  // 撤销到快照 s 时的状态，并释放 s
+  void rollback(Snapshot s) {
+    assert(snapshotCnt > 0 && s <= journal.size());
+    while (journal.size() > s) {
+      const JournalEntry &e = journal.back();
+      switch (e.kind) {
+      case JournalEntry::Kind::COLDNESS:
+        coldness[e.r * n + e.c] = e.old;
+        break;
+      case JournalEntry::Kind::BLOCK:
+        if (e.old)
+          columns[e.r * n + e.c] |= std::uint32_t(1) << e.h;
+        else
+          columns[e.r * n + e.c] &= ~(std::uint32_t(1) << e.h);
+        break;
+      case JournalEntry::Kind::BLOCK_CNT:
+        blockCnt = e.old;
+        break;
+      }
+      journal.pop_back();
+    }
+    release(s);
+  }
+
+  // 保留快照 s 之后的修改，释放 s
+  void release([[maybe_unused]] Snapshot s) {
+    assert(snapshotCnt > 0 && s <= journal.size());
+    if (!--snapshotCnt)
+      journal.clear();
   }
 
   // ICE_BARRAGE R C D S
-  void shot(int r, int c, int d, int s) {
+  // 返回冻住的格子数
+  int shot(int r, int c, int d, int s) {
     assert(r >= 0 && r < n);
     assert(c >= 0 && c < n);
     assert(s >= 0 && s <= n); // 题面锅了
@@ -274,31 +838,34 @@ public:
     for (int i = 0; i <= s; ++i) {
       if (!inRange(r, c, 0))
         break;
-      if (hasBlock[r][c][0])
+      if (hasBlock(r, c, 0))
         break;
-      if (coldness[r][c] < 4) {
-        ++coldness[r][c];
+      if (coldness[r * n + c] < 4) {
+        setColdness(r, c, coldness[r * n + c] + 1);
         ++cnt;
       }
       r += delta1[d][0];
       c += delta1[d][1];
     }
-    std::cout << "CIRNO FREEZED " << cnt << " BLOCK(S)\n";
+    *out << "CIRNO FREEZED " << cnt << " BLOCK(S)\n";
+    return cnt;
   }
 
   // MAKE_ICE_BLOCK
-  void makeIceBlock() {
-    const int oldBlockCnt = blockCnt;
+  // 返回新做出的冰砖数
+  int makeIceBlock() {
+    const std::int64_t oldBlockCnt = blockCnt;
     for (int i = 0; i < n; ++i) {
       for (int j = 0; j < n; ++j) {
-        if (coldness[i][j] == 4) {
-          coldness[i][j] = 0;
-          ++blockCnt;
+        if (coldness[i * n + j] == 4) {
+          setColdness(i, j, 0);
+          setBlockCnt(blockCnt + 1);
         }
       }
     }
-    std::cout << "CIRNO MADE " << blockCnt - oldBlockCnt
-              << " ICE BLOCK(S),NOW SHE HAS " << blockCnt << " ICE BLOCK(S)\n";
+    *out << "CIRNO MADE " << blockCnt - oldBlockCnt
+         << " ICE BLOCK(S),NOW SHE HAS " << blockCnt << " ICE BLOCK(S)\n";
+    return static_cast<int>(blockCnt - oldBlockCnt); // 至多 n * n
   }
 
   // PUT_ICE_BLOCK R C H
@@ -307,27 +874,27 @@ public:
     assert(c >= 0 && c < n);
     assert(h >= 0 && h < hm);
     if (!blockCnt) {
-      std::cout << "CIRNO HAS NO ICE_BLOCK\n";
+      *out << "CIRNO HAS NO ICE_BLOCK\n";
       return;
     }
-    if (hasBlock[r][c][h] || (h > 0 && !hasBlockAround(r, c, h))) {
-      std::cout << "BAKA CIRNO,CAN'T PUT HERE\n";
+    if (hasBlock(r, c, h) || (h > 0 && !hasBlockAround(r, c, h))) {
+      *out << "BAKA CIRNO,CAN'T PUT HERE\n";
       return;
     }
-    --blockCnt;
-    hasBlock[r][c][h] = true;
+    setBlockCnt(blockCnt - 1);
+    setBlock(r, c, h, true);
     if (h == 0)
-      coldness[r][c] = 0;
+      setColdness(r, c, 0);
     if (r < hr || r > hr + hx - 1 || c < hc || c > hc + hy - 1) {
-      std::cout << "CIRNO MISSED THE PLACE\n";
+      *out << "CIRNO MISSED THE PLACE\n";
       return;
     }
     if (r >= hr + 1 && r <= hr + hx - 2 && c >= hc + 1 && c <= hc + hy - 2) {
-      std::cout << "CIRNO PUT AN ICE_BLOCK INSIDE THE HOUSE\n";
+      *out << "CIRNO PUT AN ICE_BLOCK INSIDE THE HOUSE\n";
       return;
     }
-    std::cout << "CIRNO SUCCESSFULLY PUT AN ICE_BLOCK,NOW SHE HAS " << blockCnt
-              << " ICE_BLOCK(S)\n";
+    *out << "CIRNO SUCCESSFULLY PUT AN ICE_BLOCK,NOW SHE HAS " << blockCnt
+         << " ICE_BLOCK(S)\n";
   }
 
   // REMOVE_ICE_BLOCK R C H
@@ -335,95 +902,55 @@ public:
     assert(r >= 0 && r < n);
     assert(c >= 0 && c < n);
     assert(h >= 0 && h <= hm);
-    if (!hasBlock[r][c][h]) {
-      std::cout << "BAKA CIRNO,THERE IS NO ICE_BLOCK\n";
+    if (!hasBlock(r, c, h)) {
+      *out << "BAKA CIRNO,THERE IS NO ICE_BLOCK\n";
       return;
     }
-    hasBlock[r][c][h] = false;
-    const int oldCnt = countInFieldBlocks();
+    setBlock(r, c, h, false);
+    const std::int64_t oldCnt = countInFieldBlocks();
     removeDanglingIceBlocks();
-    ++blockCnt;
-    const int cnt = countInFieldBlocks();
+    setBlockCnt(blockCnt + 1);
+    const std::int64_t cnt = countInFieldBlocks();
     if (cnt < oldCnt)
-      std::cout << "CIRNO REMOVED AN ICE_BLOCK,AND " << oldCnt - cnt
-                << " BLOCK(S) ARE BROKEN\n";
+      *out << "CIRNO REMOVED AN ICE_BLOCK,AND " << oldCnt - cnt
+           << " BLOCK(S) ARE BROKEN\n";
     else
-      std::cout << "CIRNO REMOVED AN ICE_BLOCK\n";
+      *out << "CIRNO REMOVED AN ICE_BLOCK\n";
   }
 
-  // MAKE_ROOF
-  void makeRoof() {
-    const int h = getRoofHeight(); // 屋顶高度
+  // MAKE_ROOF 的结果，足以原样复现 makeRoof 的全部输出
+  struct RoofReport {
+    enum class Result {
+      NOT_ENOUGH_FOR_ROOF, // 冰砖不够建屋顶
+      TOO_SMALL,           // 房子太小
+      BROKEN,              // 移除冰砖时房子塌了
+      NOT_ENOUGH_FOR_WALL, // 冰砖不够修墙
+      BUILT
+    };
+    Result result;
+    int height;
+    std::int64_t insideCnt = 0, outsideCnt = 0; // 需要移除的内部 / 外部冰砖数
+    bool hasDoor = false, wallNeedFix = false, cornerNeedFix = false;
+    bool perfect = false;
+    std::int64_t blockCnt = 0; // MAKE_ROOF 之后的冰砖数，只有建成时才输出
+  };
 
-    { // 冰砖是否足够
-      const int c = countBlocksInRange(hr, hr + hx - 1, hc, hc + hy - 1, h, h);
-      if (hx * hy - c > blockCnt) {
-        std::cout << "SORRY CIRNO,NOT ENOUGH ICE_BLOCK(S) TO MAKE ROOF\n";
-        return;
-      }
-    }
-    { // 空间是否足够
-      const int validSpace = (hx - 2) * (hy - 2) * h;
-      if (h < 2 || validSpace < 2) {
-        std::cout << "SORRY CIRNO,HOUSE IS TOO SMALL\n";
-        return;
-      }
-    }
-    { // 建屋顶
-      for (int i = hr; i < hr + hx; ++i) {
-        for (int j = hc; j < hc + hy; ++j) {
-          if (!hasBlock[i][j][h]) {
-            --blockCnt;
-            hasBlock[i][j][h] = true;
-          }
-        }
-      }
-    }
-    bool perfect = true;
-    { // 移除错误放置的冰砖
-      const int c = countInFieldBlocks();
-      int k1 = 0, k2 = 0;
-      for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-          for (int k = 0; k <= hm; ++k) {
-            if (!hasBlock[i][j][k])
-              continue;
-            if (i > hr && i < hr + hx - 1 && j > hc && j < hc + hy - 1 &&
-                k < h) {
-              // 内部
-              ++k1;
-              hasBlock[i][j][k] = false;
-            }
-            if (i < hr || i > hr + hx - 1 || j < hc || j > hc + hy - 1 ||
-                k > h) {
-              // 外部
-              ++k2;
-              hasBlock[i][j][k] = false;
-            }
-          }
-        }
-      }
-      std::cout << k1 << " ICE_BLOCK(S) INSIDE THE HOUSE NEED TO BE REMOVED\n";
-      std::cout << k2 << " ICE_BLOCK(S) OUTSIDE THE HOUSE NEED TO BE REMOVED\n";
-      if (k1 > 0 || k2 > 0) {
-        perfect = false;
-        removeDanglingIceBlocks();
-      }
-      if (!hasBlock[hr][hc][h]) {
-        std::cout << "SORRY CIRNO,HOUSE IS BROKEN WHEN REMOVING BLOCKS\n";
-        return;
-      }
-      blockCnt += c - countInFieldBlocks();
-    }
-    bool wallNeedFix = false, hasDoor = false;
+private:
+  // MAKE_ROOF 的后半段：修墙、开门、修四角、完美判定
+  // has(r, c, h) 给出移除冰砖、修好门边四角之后的网格
+  // report.blockCnt 是此时的冰砖数，结束时更新为最终冰砖数
+  template <class Has>
+  static void finishRoof(const House &target, int h, DoorState doorState,
+                         int cornersNeedFix, bool perfect, Has has,
+                         RoofReport &report) {
+    const int hr = target.hr, hc = target.hc, hx = target.hx, hy = target.hy;
+    std::int64_t &blockCnt = report.blockCnt;
     { // 修补墙壁残缺 & 开门
-      int c = 0;
-      const auto [doorState, k] = getDoorState();
-      c += k;
+      int c = cornersNeedFix;
       for (int i = hr + 1; i <= hr + hx - 2; ++i) {
         for (int j : {hc, hc + hy - 1}) {
           for (int k = 0; k < h; ++k) {
-            if (!hasBlock[i][j][k])
+            if (!has(i, j, k))
               ++c;
           }
         }
@@ -431,7 +958,7 @@ public:
       for (int i : {hr, hr + hx - 1}) {
         for (int j = hc + 1; j <= hc + hy - 2; ++j) {
           for (int k = 0; k < h; ++k) {
-            if (!hasBlock[i][j][k])
+            if (!has(i, j, k))
               ++c;
           }
         }
@@ -449,17 +976,17 @@ public:
         break; // Make GCC happy
       }
       if (c > blockCnt) {
-        std::cout << "SORRY CIRNO,NOT ENOUGH ICE_BLOCKS TO FIX THE WALL\n";
+        report.result = RoofReport::Result::NOT_ENOUGH_FOR_WALL;
         return;
       }
       if (c > 0)
-        wallNeedFix = true;
+        report.wallNeedFix = true;
       blockCnt -= c;
       // 题面没有说清楚“开一个门”是否回收冰砖
       // 试验结果：不回收
       if (doorState == DoorState::HAS_DOOR ||
           doorState == DoorState::HAS_CORNER_DOOR)
-        hasDoor = true;
+        report.hasDoor = true;
       if ((doorState != DoorState::HAS_DOOR &&
            doorState != DoorState::HAS_CORNER_DOOR) ||
           c > 0)
@@ -470,16 +997,14 @@ public:
         break;
       case DoorState::HAS_HALF_DOOR:
       case DoorState::HAS_HALF_CORNER_DOOR:
-        ++blockCnt;
+        blockCnt += 1;
         break;
       case DoorState::HAS_DOOR:
       case DoorState::HAS_CORNER_DOOR:
         break; // Make GCC happy again
       }
     }
-    std::cout << "GOOD JOB CIRNO,SUCCESSFULLY BUILT THE HOUSE\n";
-    std::cout << (hasDoor ? "DOOR IS OK\n" : "HOUSE HAS NO DOOR\n");
-    std::cout << (wallNeedFix ? "WALL NEED TO BE FIXED\n" : "WALL IS OK\n");
+    report.result = RoofReport::Result::BUILT;
     { // 修复四角
       int c = 0;
       for (auto [i, j] : std::initializer_list<std::pair<int, int>>{
@@ -488,80 +1013,383 @@ public:
                {hr + hx - 1, hc},
                {hr + hx - 1, hc + hy - 1}}) {
         for (int k = 0; k < h; ++k) {
-          if (!hasBlock[i][j][k])
+          if (!has(i, j, k))
             ++c;
         }
       }
       if (c > 0) {
-        std::cout << "CORNER NEED TO BE FIXED\n";
-        blockCnt = std::max(0, blockCnt - c);
+        report.cornerNeedFix = true;
+        blockCnt = std::max<std::int64_t>(0, blockCnt - c);
         perfect = false;
-      } else
-        std::cout << "CORNER IS OK\n";
+      }
     }
-    std::cout << "CIRNO FINALLY HAS " << blockCnt << " ICE_BLOCK(S)\n";
     { // 完美判定
       if (perfect) {
         perfect = false;
         for (int i : {hr + (hx - 1) / 2, hr + hx / 2}) {
           for (int j : {hc, hc + hy - 1}) {
-            if (!hasBlock[i][j][0])
+            if (!has(i, j, 0))
               perfect = true;
           }
         }
         for (int i : {hr, hr + hx - 1}) {
           for (int j : {hc + (hy - 1) / 2, hc + hy / 2}) {
-            if (!hasBlock[i][j][0])
+            if (!has(i, j, 0))
               perfect = true;
           }
         }
-        if (perfect)
-          std::cout << "CIRNO IS PERFECT!\n";
       }
+      report.perfect = perfect;
     }
   }
+
+  int getRoofHeight(const House &target) const {
+    return getRoofHeight(target.hr, target.hc, target.hx, target.hy);
+  }
+
+  // MAKE_ROOF 的全部判定：以 target 为房子、在高度 h 建屋顶，只读，不拷贝网格
+  // fieldCnt 是当前场上的冰砖数，由调用者统一算好
+  // 建屋顶、移除冰砖之后只剩房子范围内 [0, h] 层的格子，在局部网格上模拟即可
+  // grid 按行存房子里的每一格，和 columns 一样第 k 位表示高度 k；
+  // 返回时是 MAKE_ROOF 之后房子里的样子，没有走到建屋顶这一步时为空
+  RoofReport simulateRoof(const House &target, int h, std::int64_t fieldCnt,
+                          std::vector<std::uint32_t> &grid) const {
+    assert(h >= 0 && h <= hm);
+    const int hr = target.hr, hc = target.hc, hx = target.hx, hy = target.hy;
+    RoofReport report;
+    report.height = h;
+    report.blockCnt = blockCnt;
+    grid.clear();
+
+    { // 冰砖是否足够
+      const std::int64_t roofCnt =
+          std::int64_t(hx) * hy -
+          countBlocksInRange(hr, hr + hx - 1, hc, hc + hy - 1, h, h);
+      if (roofCnt > report.blockCnt) {
+        report.result = RoofReport::Result::NOT_ENOUGH_FOR_ROOF;
+        return report;
+      }
+      // 空间是否足够
+      const std::int64_t validSpace = std::int64_t(hx - 2) * (hy - 2) * h;
+      if (h < 2 || validSpace < 2) {
+        report.result = RoofReport::Result::TOO_SMALL;
+        return report;
+      }
+      // 建屋顶
+      report.blockCnt -= roofCnt;
+      fieldCnt += roofCnt;
+    }
+    const auto index = [&](int r, int c) {
+      return std::size_t(r - hr) * hy + (c - hc);
+    };
+    const std::uint32_t below = (std::uint32_t(1) << h) - 1; // [0, h) 层
+    grid.assign(std::size_t(hx) * hy, 0);
+    for (int i = hr; i < hr + hx; ++i) {
+      for (int j = hc; j < hc + hy; ++j)
+        grid[index(i, j)] = (target.isWall(i, j) ? columns[i * n + j] & below
+                                                 : 0) |
+                            std::uint32_t(1) << h;
+    }
+    bool perfect = true;
+    { // 移除错误放置的冰砖
+      const std::int64_t k1 =
+          hx > 2 && hy > 2 ? countBlocksInRange(hr + 1, hr + hx - 2, hc + 1,
+                                                hc + hy - 2, 0, h - 1)
+                           : 0;
+      const std::int64_t k2 =
+          fieldCnt - std::int64_t(hx) * hy -
+          countBlocksInRange(hr, hr + hx - 1, hc, hc + hy - 1, 0, h - 1);
+      report.insideCnt = k1;
+      report.outsideCnt = k2;
+      if (k1 > 0 || k2 > 0) {
+        perfect = false;
+        // 局部网格上的悬空判定，和 removeDanglingIceBlocks 一致
+        std::vector<std::uint32_t> reached(grid.size(), 0);
+        std::queue<std::tuple<int, int, int>> queue;
+        for (int i = hr; i < hr + hx; ++i) {
+          for (int j = hc; j < hc + hy; ++j) {
+            if (grid[index(i, j)] & 1) {
+              queue.emplace(i, j, 0);
+              reached[index(i, j)] |= 1;
+            }
+          }
+        }
+        while (!queue.empty()) {
+          const auto [r, c, k] = queue.front();
+          queue.pop();
+          for (int i = 0; i < 6; ++i) {
+            const int _r = r + delta2[i][0];
+            const int _c = c + delta2[i][1];
+            const int _k = k + delta2[i][2];
+            if (target.contains(_r, _c) && _k >= 0 && _k <= h &&
+                grid[index(_r, _c)] >> _k & 1 &&
+                !(reached[index(_r, _c)] >> _k & 1)) {
+              queue.emplace(_r, _c, _k);
+              reached[index(_r, _c)] |= std::uint32_t(1) << _k;
+            }
+          }
+        }
+        grid.swap(reached);
+      }
+      if (!(grid[index(hr, hc)] >> h & 1)) {
+        report.result = RoofReport::Result::BROKEN;
+        return report;
+      }
+      std::int64_t remaining = 0;
+      for (const std::uint32_t column : grid)
+        remaining += __builtin_popcount(column);
+      report.blockCnt += fieldCnt - remaining;
+    }
+    const auto has = [&](int r, int c, int k) {
+      return target.contains(r, c) && k <= h && grid[index(r, c)] >> k & 1;
+    };
+    const DoorInfo door = classifyDoor(target, getEmptyMask(target, 0, has),
+                                       getEmptyMask(target, 1, has));
+    if (door.fix)
+      fixCornerForDoor(target, door.fix->r, door.fix->c, door.fixH1,
+                       door.fixH2, [&](int i, int j, int k) {
+                         grid[index(i, j)] |= std::uint32_t(1) << k;
+                       });
+    finishRoof(target, h, door.doorState, door.cornersNeedFix, perfect, has,
+               report);
+    return report;
+  }
+
+  // 只读地试算以 target 为房子、在高度 h 建屋顶的结果
+  RoofReport evaluateHouse(const House &target, int h,
+                           std::int64_t fieldCnt) const {
+    std::vector<std::uint32_t> grid;
+    return simulateRoof(target, h, fieldCnt, grid);
+  }
+
+public:
+  // 在高度 h 建屋顶并直接修改当前世界，不输出
+  // 判定都在 simulateRoof 里，这里只把它给出的网格和冰砖数写回：
+  // 房子外面清空，房子里换成 grid，只改动实际变化的格子
+  RoofReport buildRoof(int h) {
+    std::vector<std::uint32_t> grid;
+    const RoofReport report =
+        simulateRoof(house, h, countInFieldBlocks(), grid);
+    if (!grid.empty()) {
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+          const std::uint32_t column =
+              house.contains(i, j) ? grid[std::size_t(i - hr) * hy + (j - hc)]
+                                   : 0;
+          for (std::uint32_t diff = columns[i * n + j] ^ column; diff;
+               diff &= diff - 1) {
+            const int k = __builtin_ctz(diff);
+            setBlock(i, j, k, column >> k & 1);
+          }
+        }
+      }
+    }
+    setBlockCnt(report.blockCnt);
+    return report;
+  }
+
+  void printRoofReport(const RoofReport &report) const {
+    using Result = RoofReport::Result;
+    switch (report.result) {
+    case Result::NOT_ENOUGH_FOR_ROOF:
+      *out << "SORRY CIRNO,NOT ENOUGH ICE_BLOCK(S) TO MAKE ROOF\n";
+      return;
+    case Result::TOO_SMALL:
+      *out << "SORRY CIRNO,HOUSE IS TOO SMALL\n";
+      return;
+    default:
+      break;
+    }
+    *out << report.insideCnt
+         << " ICE_BLOCK(S) INSIDE THE HOUSE NEED TO BE REMOVED\n";
+    *out << report.outsideCnt
+         << " ICE_BLOCK(S) OUTSIDE THE HOUSE NEED TO BE REMOVED\n";
+    switch (report.result) {
+    case Result::BROKEN:
+      *out << "SORRY CIRNO,HOUSE IS BROKEN WHEN REMOVING BLOCKS\n";
+      return;
+    case Result::NOT_ENOUGH_FOR_WALL:
+      *out << "SORRY CIRNO,NOT ENOUGH ICE_BLOCKS TO FIX THE WALL\n";
+      return;
+    default:
+      break;
+    }
+    *out << "GOOD JOB CIRNO,SUCCESSFULLY BUILT THE HOUSE\n";
+    *out << (report.hasDoor ? "DOOR IS OK\n" : "HOUSE HAS NO DOOR\n");
+    *out << (report.wallNeedFix ? "WALL NEED TO BE FIXED\n" : "WALL IS OK\n");
+    *out << (report.cornerNeedFix ? "CORNER NEED TO BE FIXED\n"
+                                  : "CORNER IS OK\n");
+    *out << "CIRNO FINALLY HAS " << report.blockCnt << " ICE_BLOCK(S)\n";
+    if (report.perfect)
+      *out << "CIRNO IS PERFECT!\n";
+  }
+
+  // 不修改当前世界，回答“现在在高度 h 建屋顶会怎样”
+  RoofReport evaluateRoof(int h) const {
+    return evaluateHouse(house, h, peekInFieldBlocks());
+  }
+
+  RoofReport evaluateRoof() const { return evaluateRoof(getRoofHeight()); }
+
+  // 批量试算：pool 需要提供 parallelFor(count, f)，见 thread_pool.hpp
+  // 各个高度互不影响，结果按 heights 的顺序返回
+  template <class Pool>
+  std::vector<RoofReport> evaluateRoofs(Pool &pool,
+                                        const std::vector<int> &heights) const {
+    const std::int64_t fieldCnt = peekInFieldBlocks(); // 各个高度共用
+    std::vector<RoofReport> reports(heights.size());
+    pool.parallelFor(static_cast<int>(heights.size()), [&](int i) {
+      reports[i] = evaluateHouse(house, heights[i], fieldCnt);
+    });
+    return reports;
+  }
+
+  // 批量试算：多个候选世界，各自在自然的屋顶高度上
+  // 试算只读网格、不碰 stats，同一个世界出现几次都可以
+  template <class Pool>
+  static std::vector<RoofReport>
+  evaluateRoofs(Pool &pool, const std::vector<const World *> &worlds) {
+    std::vector<RoofReport> reports(worlds.size());
+    pool.parallelFor(static_cast<int>(worlds.size()), [&](int i) {
+      reports[i] = worlds[i]->evaluateRoof();
+    });
+    return reports;
+  }
+
+  // 登记一个候选房子，返回编号；reset 之后清空
+  int addHouse(int hr, int hc, int hx, int hy) {
+    assert(isValidShape(n, hm, hr, hc, hx, hy));
+    houses.emplace_back(hr, hc, hx, hy);
+    return static_cast<int>(houses.size()) - 1;
+  }
+
+  int getHouseCnt() const { return static_cast<int>(houses.size()); }
+
+  // 不修改当前世界，回答“以第 i 个候选房子为准 MAKE_ROOF 会怎样”
+  RoofReport evaluateHouse(int i) const {
+    return evaluateHouse(houses[i], getRoofHeight(houses[i]),
+                         peekInFieldBlocks());
+  }
+
+  // 批量试算所有候选房子：各房子只读共享同一份网格，按登记顺序返回
+  template <class Pool>
+  std::vector<RoofReport> evaluateHouses(Pool &pool) const {
+    const std::int64_t fieldCnt = peekInFieldBlocks(); // 各个房子共用
+    std::vector<RoofReport> reports(houses.size());
+    pool.parallelFor(static_cast<int>(houses.size()), [&](int i) {
+      reports[i] = evaluateHouse(houses[i], getRoofHeight(houses[i]), fieldCnt);
+    });
+    return reports;
+  }
+
+  // MAKE_ROOF
+  void makeRoof() { printRoofReport(buildRoof(getRoofHeight())); }
 };
 
-int main() {
-  std::ios::sync_with_stdio(false);
-  std::cin.tie(nullptr);
-  int n, hm, hr, hc, hx, hy;
-  std::cin >> n >> hm >> hr >> hc >> hx >> hy;
-  World world(n, hm, hr, hc, hx, hy);
-  int m;
-  std::cin >> m;
+#ifdef WORLD_PROFILE
+#include "profile.hpp"
+
+inline CommandProfile commandProfile({"ICE_BARRAGE", "MAKE_ICE_BLOCK",
+                                      "PUT_ICE_BLOCK", "REMOVE_ICE_BLOCK",
+                                      "MAKE_ROOF", "UNKNOWN"});
+#endif
+
+// 读入 opcode 的参数并执行
+void runCommand(World &world, Opcode opcode, Reader &in) {
+  switch (opcode) {
+  case Opcode::ICE_BARRAGE: {
+    const int r = in.integer(), c = in.integer();
+    const int d = in.integer(), s = in.integer();
+    world.shot(r, c, d, s);
+    break;
+  }
+  case Opcode::MAKE_ICE_BLOCK:
+    world.makeIceBlock();
+    break;
+  case Opcode::PUT_ICE_BLOCK: {
+    const int r = in.integer(), c = in.integer(), h = in.integer();
+    world.putIceBlock(r, c, h);
+    break;
+  }
+  case Opcode::REMOVE_ICE_BLOCK: {
+    const int r = in.integer(), c = in.integer(), h = in.integer();
+    world.removeIceBlock(r, c, h);
+    break;
+  }
+  case Opcode::MAKE_ROOF:
+    world.makeRoof();
+    break;
+  case Opcode::UNKNOWN:
+    assert(false);
+    break;
+  }
+}
+
+// 读入 opcode 的参数，只检查是否在范围内，不执行
+bool isValidCommand(const World &world, Opcode opcode, Reader &in) {
+  switch (opcode) {
+  case Opcode::ICE_BARRAGE: {
+    const int r = in.integer(), c = in.integer();
+    const int d = in.integer(), s = in.integer();
+    return in.good() && world.isValidShot(r, c, d, s);
+  }
+  case Opcode::PUT_ICE_BLOCK: {
+    const int r = in.integer(), c = in.integer(), h = in.integer();
+    return in.good() && world.isValidPut(r, c, h);
+  }
+  case Opcode::REMOVE_ICE_BLOCK: {
+    const int r = in.integer(), c = in.integer(), h = in.integer();
+    return in.good() && world.isValidRemove(r, c, h);
+  }
+  case Opcode::MAKE_ICE_BLOCK:
+  case Opcode::MAKE_ROOF:
+    return true;
+  case Opcode::UNKNOWN:
+    break;
+  }
+  return false;
+}
+
+// 执行一份完整的输入
+void run(Reader &in, Writer &out) {
+  const int n = in.integer(), hm = in.integer();
+  const int hr = in.integer(), hc = in.integer();
+  const int hx = in.integer(), hy = in.integer();
+  World world(n, hm, hr, hc, hx, hy, out);
+  int m = in.integer();
+#ifndef WORLD_LARGE
   assert(m >= 10 && m <= 1000);
+#endif
   while (m--) {
-    std::string opt;
-    std::cin >> opt;
-    if (opt == "ICE_BARRAGE") {
-      int r, c, d, s;
-      std::cin >> r >> c >> d >> s;
-      world.shot(r, c, d, s);
-      continue;
-    }
-    if (opt == "MAKE_ICE_BLOCK") {
-      world.makeIceBlock();
-      continue;
-    }
-    if (opt == "PUT_ICE_BLOCK") {
-      int r, c, h;
-      std::cin >> r >> c >> h;
-      world.putIceBlock(r, c, h);
-      continue;
-    }
-    if (opt == "REMOVE_ICE_BLOCK") {
-      int r, c, h;
-      std::cin >> r >> c >> h;
-      world.removeIceBlock(r, c, h);
-      continue;
-    }
-    if (opt == "MAKE_ROOF") {
+    const Opcode opcode = parseOpcode(in.token());
+#ifdef WORLD_PROFILE
+    const CommandProfile::Timer timer(commandProfile, static_cast<int>(opcode));
+#endif
+    runCommand(world, opcode, in);
+    if (opcode == Opcode::MAKE_ROOF) {
       assert(m == 0);
-      world.makeRoof();
       break;
     }
-    assert(false);
   }
+#ifdef WORLD_PROFILE
+  const World::Stats &stats = world.getStats();
+  commandProfile.addCounter("dangling_calls", stats.danglingCalls);
+  commandProfile.addCounter("dangling_visited", stats.danglingVisited);
+  commandProfile.addCounter("dangling_removed", stats.danglingRemoved);
+  commandProfile.addCounter("field_scans", stats.fieldScans);
+#endif
+}
+
+// planner.cpp 等工具定义 WORLD_NO_MAIN 后直接包含本文件
+#ifndef WORLD_NO_MAIN
+int main() {
+  Reader in(stdin);
+  Writer out(stdout);
+  run(in, out);
+#ifdef WORLD_PROFILE
+  commandProfile.report(stderr);
+  std::fputc('\n', stderr);
+#endif
   return 0;
-}
\ No newline at end of file
+}
+#endif
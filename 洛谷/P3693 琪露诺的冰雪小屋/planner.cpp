@@ -0,0 +1,274 @@
+// 自动规划：读入 n hm hr hc hx hy，输出一份以 CIRNO IS PERFECT! 结尾、
+// 尽量短的操作序列，可以直接喂给 main.cpp
+// 用法：./planner [束宽] [线程数]
+// 编译：g++ -std=c++20 -O2 -pthread planner.cpp -o planner
+
+#define WORLD_NO_MAIN
+#include "main.cpp"
+#include "thread_pool.hpp"
+
+#include <string>
+#include <unordered_set>
+
+namespace {
+
+struct Command {
+  Opcode opcode;
+  int args[4];
+};
+
+void printCommand(Writer &out, const Command &cmd) {
+  switch (cmd.opcode) {
+  case Opcode::ICE_BARRAGE:
+    out << "ICE_BARRAGE " << cmd.args[0] << ' ' << cmd.args[1] << ' '
+        << cmd.args[2] << ' ' << cmd.args[3] << '\n';
+    break;
+  case Opcode::MAKE_ICE_BLOCK:
+    out << "MAKE_ICE_BLOCK\n";
+    break;
+  case Opcode::PUT_ICE_BLOCK:
+    out << "PUT_ICE_BLOCK " << cmd.args[0] << ' ' << cmd.args[1] << ' '
+        << cmd.args[2] << '\n';
+    break;
+  case Opcode::REMOVE_ICE_BLOCK:
+    out << "REMOVE_ICE_BLOCK " << cmd.args[0] << ' ' << cmd.args[1] << ' '
+        << cmd.args[2] << '\n';
+    break;
+  case Opcode::MAKE_ROOF:
+    out << "MAKE_ROOF\n";
+    break;
+  case Opcode::UNKNOWN:
+    assert(false);
+    break;
+  }
+}
+
+void applyCommand(World &world, const Command &cmd) {
+  switch (cmd.opcode) {
+  case Opcode::ICE_BARRAGE:
+    world.shot(cmd.args[0], cmd.args[1], cmd.args[2], cmd.args[3]);
+    break;
+  case Opcode::MAKE_ICE_BLOCK:
+    world.makeIceBlock();
+    break;
+  case Opcode::PUT_ICE_BLOCK:
+    world.putIceBlock(cmd.args[0], cmd.args[1], cmd.args[2]);
+    break;
+  case Opcode::REMOVE_ICE_BLOCK:
+    world.removeIceBlock(cmd.args[0], cmd.args[1], cmd.args[2]);
+    break;
+  case Opcode::MAKE_ROOF:
+    world.makeRoof();
+    break;
+  case Opcode::UNKNOWN:
+    assert(false);
+    break;
+  }
+}
+
+class Planner {
+private:
+  int n, hm, hr, hc, hx, hy;
+  int need;               // 建墙 + 屋顶一共需要的冰砖
+  Writer silent{nullptr}; // 只在主线程上用
+
+  struct Node {
+    World world;
+    std::vector<Command> script;
+    int credit; // 4 * 冰砖数 + 冷冻度之和，即已经打出的有效冷冻次数
+  };
+
+  struct Candidate {
+    int parent;
+    Command cmd;
+    int credit;
+    std::int64_t blockCnt;
+    int estimate; // 到攒够冰砖为止至少还要几条命令
+  };
+
+  // 启发函数：每发 ICE_BARRAGE 最多冻 n 格，每次 MAKE_ICE_BLOCK 最多做 n^2 块
+  // 都是下界，所以对 A* 可采纳
+  int estimate(int credit, std::int64_t blockCnt) const {
+    if (blockCnt >= need)
+      return 0;
+    const int barrages = (std::max(0, 4 * need - credit) + n - 1) / n;
+    const int makes =
+        static_cast<int>((need - blockCnt + n * n - 1) / (n * n));
+    return barrages + makes;
+  }
+
+  // 束里去重用的完整状态：攒冰砖时场上没有冰砖，只有冰砖数和冷冻度
+  std::string getState(const World &world) const {
+    std::string state(n * n, 0);
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j)
+        state[i * n + j] = static_cast<char>(world.getColdness(i, j));
+    }
+    state += std::to_string(world.getBlockCnt());
+    return state;
+  }
+
+  // 一个任务：某个节点的某个方向上的所有 ICE_BARRAGE
+  // （d == 8 表示 MAKE_ICE_BLOCK）
+  // 各任务并行，输出丢进自己的 Writer，不能共用 silent
+  void expand(const Node &node, int parent, int d,
+              std::vector<Candidate> &result) const {
+    Writer discard(nullptr);
+    World world = node.world;
+    world.setOutput(discard);
+    const std::int64_t blockCnt = world.getBlockCnt();
+    if (d == 8) {
+      if (world.makeIceBlock() > 0)
+        result.push_back({parent,
+                          {Opcode::MAKE_ICE_BLOCK, {}},
+                          node.credit,
+                          world.getBlockCnt(),
+                          estimate(node.credit, world.getBlockCnt())});
+      return;
+    }
+    for (int r = 0; r < n; ++r) {
+      for (int c = 0; c < n; ++c) {
+        const World::Snapshot s = world.snapshot();
+        const int cnt = world.shot(r, c, d, n);
+        world.rollback(s);
+        if (cnt == 0)
+          continue;
+        result.push_back({parent,
+                          {Opcode::ICE_BARRAGE, {r, c, d, n}},
+                          node.credit + cnt,
+                          blockCnt,
+                          estimate(node.credit + cnt, blockCnt)});
+      }
+    }
+  }
+
+  // 在攒够冰砖的世界上补齐墙和屋顶，门开在 (dr, dc)
+  std::vector<Command> finish(int dr, int dc) const {
+    std::vector<Command> tail;
+    for (int k = 0; k < 2; ++k) {
+      for (int i = hr; i < hr + hx; ++i) {
+        for (int j = hc; j < hc + hy; ++j) {
+          const bool onWall =
+              i == hr || i == hr + hx - 1 || j == hc || j == hc + hy - 1;
+          if (onWall && (i != dr || j != dc))
+            tail.push_back({Opcode::PUT_ICE_BLOCK, {i, j, k}});
+        }
+      }
+    }
+    tail.push_back({Opcode::MAKE_ROOF, {}});
+    return tail;
+  }
+
+  // 放好墙之后试算一次 MAKE_ROOF，看是否完美
+  static bool isPerfect(World world, const std::vector<Command> &tail) {
+    for (const Command &cmd : tail) {
+      if (cmd.opcode != Opcode::MAKE_ROOF)
+        applyCommand(world, cmd);
+    }
+    return world.evaluateRoof().perfect;
+  }
+
+public:
+  Planner(int n, int hm, int hr, int hc, int hx, int hy)
+      : n(n), hm(hm), hr(hr), hc(hc), hx(hx), hy(hy),
+        need(2 * (2 * (hx + hy) - 4) - 2 + hx * hy) {}
+
+  // 束搜索：每层所有节点的 g 相同，按启发值挑出最好的 width 个
+  // 成功时返回完整脚本，失败返回空
+  std::vector<Command> plan(int width, ThreadPool &pool) {
+    // 这样的房子不可能 PERFECT：1x1 时唯一的格子既是四个角又是正中，
+    // 角补齐了正中就开不了门；其余的 MAKE_ROOF 都是 HOUSE IS TOO SMALL
+    if (hx < 3 || hy < 3)
+      return {};
+    std::vector<Node> beam;
+    beam.push_back({World(n, hm, hr, hc, hx, hy, silent), {}, 0});
+    for (;;) {
+      for (const Node &node : beam) {
+        if (node.world.getBlockCnt() >= need)
+          return complete(node);
+      }
+      // 并行扩展：任务是 (节点, 方向)，每个任务在自己的 World 副本上试探
+      const int taskCnt = static_cast<int>(beam.size()) * 9;
+      std::vector<std::vector<Candidate>> results(taskCnt);
+      pool.parallelFor(taskCnt, [&](int t) {
+        expand(beam[t / 9], t / 9, t % 9, results[t]);
+      });
+
+      std::vector<Candidate> candidates;
+      for (const std::vector<Candidate> &result : results)
+        candidates.insert(candidates.end(), result.begin(), result.end());
+      if (candidates.empty())
+        return {};
+      std::stable_sort(candidates.begin(), candidates.end(),
+                       [](const Candidate &a, const Candidate &b) {
+                         if (a.estimate != b.estimate)
+                           return a.estimate < b.estimate;
+                         return a.credit > b.credit;
+                       });
+      std::vector<Node> nextBeam;
+      std::unordered_set<std::string> seen;
+      for (const Candidate &candidate : candidates) {
+        if (static_cast<int>(nextBeam.size()) == width)
+          break;
+        Node node = beam[candidate.parent];
+        applyCommand(node.world, candidate.cmd);
+        if (!seen.insert(getState(node.world)).second)
+          continue;
+        node.script.push_back(candidate.cmd);
+        node.credit = candidate.credit;
+        nextBeam.push_back(std::move(node));
+      }
+      beam = std::move(nextBeam);
+    }
+  }
+
+  // 冰砖够了，挑一个能让 MAKE_ROOF 判完美的门
+  std::vector<Command> complete(const Node &node) {
+    std::vector<std::pair<int, int>> doors;
+    for (int i : {hr + (hx - 1) / 2, hr + hx / 2}) {
+      for (int j : {hc, hc + hy - 1})
+        doors.emplace_back(i, j);
+    }
+    for (int i : {hr, hr + hx - 1}) {
+      for (int j : {hc + (hy - 1) / 2, hc + hy / 2})
+        doors.emplace_back(i, j);
+    }
+    for (auto [dr, dc] : doors) {
+      const std::vector<Command> tail = finish(dr, dc);
+      if (isPerfect(node.world, tail)) {
+        std::vector<Command> script = node.script;
+        script.insert(script.end(), tail.begin(), tail.end());
+        return script;
+      }
+    }
+    return {};
+  }
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const int width = argc > 1 ? std::atoi(argv[1]) : 16;
+  ThreadPool pool(argc > 2 ? std::atoi(argv[2])
+                          : std::max(1U, std::thread::hardware_concurrency()));
+  Reader in(stdin);
+  Writer out(stdout);
+  const int n = in.integer(), hm = in.integer();
+  const int hr = in.integer(), hc = in.integer();
+  const int hx = in.integer(), hy = in.integer();
+  Planner planner(n, hm, hr, hc, hx, hy);
+  const std::vector<Command> script = planner.plan(width, pool);
+  if (script.empty()) {
+    std::fputs("no perfect house found\n", stderr);
+    return 1;
+  }
+  if (script.size() > 1000)
+    std::fprintf(stderr, "warning: %zu commands, over the limit of 1000\n",
+                 script.size());
+  out << n << ' ' << hm << '\n';
+  out << hr << ' ' << hc << ' ' << hx << ' ' << hy << '\n';
+  out << static_cast<int>(script.size()) << '\n';
+  for (const Command &cmd : script)
+    printCommand(out, cmd);
+  return 0;
+}
@@ -0,0 +1,135 @@
+// 按命令统计耗时，定义 WORLD_PROFILE 时由 main.cpp 包含，评测时不参与编译
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// 对数分桶的耗时直方图：每个 2 的幂区间再均分 8 份，相对误差不超过 1/8
+class LatencyHistogram {
+private:
+  static constexpr int SUB_BITS = 3;
+  static constexpr int SUB = 1 << SUB_BITS;
+  static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB;
+
+  std::vector<std::uint64_t> buckets = std::vector<std::uint64_t>(BUCKETS, 0);
+  std::uint64_t cnt = 0, sum = 0, maxVal = 0;
+
+  static int bucketOf(std::uint64_t v) {
+    if (v < SUB)
+      return static_cast<int>(v);
+    const int e = 63 - __builtin_clzll(v);
+    return (e - SUB_BITS + 1) * SUB +
+           static_cast<int>(v >> (e - SUB_BITS) & (SUB - 1));
+  }
+
+  // 桶内最大值
+  static std::uint64_t upperOf(int bucket) {
+    if (bucket < SUB)
+      return bucket;
+    const int e = bucket / SUB + SUB_BITS - 1;
+    const std::uint64_t base = std::uint64_t(1) << e;
+    const std::uint64_t width = base >> SUB_BITS;
+    return base + width * (bucket % SUB + 1) - 1;
+  }
+
+public:
+  void record(std::uint64_t v) {
+    ++buckets[bucketOf(v)];
+    ++cnt;
+    sum += v;
+    maxVal = std::max(maxVal, v);
+  }
+
+  std::uint64_t count() const { return cnt; }
+  std::uint64_t total() const { return sum; }
+  std::uint64_t max() const { return maxVal; }
+
+  // p 取 [0, 1]
+  std::uint64_t percentile(double p) const {
+    if (!cnt)
+      return 0;
+    const std::uint64_t rank =
+        std::max<std::uint64_t>(1, static_cast<std::uint64_t>(p * cnt + 0.5));
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+      seen += buckets[i];
+      if (seen >= rank)
+        return std::min(upperOf(i), maxVal);
+    }
+    return maxVal;
+  }
+};
+
+// 每种命令一个直方图，外加若干命名计数器
+class CommandProfile {
+private:
+  std::vector<std::string> names;
+  std::vector<LatencyHistogram> histograms;
+  std::map<std::string, std::uint64_t> counters;
+
+public:
+  explicit CommandProfile(std::vector<std::string> names)
+      : names(std::move(names)), histograms(this->names.size()) {}
+
+  class Timer {
+  private:
+    CommandProfile &profile;
+    int id;
+    std::chrono::steady_clock::time_point start;
+
+  public:
+    Timer(CommandProfile &profile, int id)
+        : profile(profile), id(id), start(std::chrono::steady_clock::now()) {}
+    Timer(const Timer &) = delete;
+    Timer &operator=(const Timer &) = delete;
+    ~Timer() {
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start);
+      profile.histograms[id].record(ns.count());
+    }
+  };
+
+  void addCounter(const std::string &name, std::uint64_t val) {
+    counters[name] += val;
+  }
+
+  void clear() {
+    histograms.assign(names.size(), LatencyHistogram());
+    counters.clear();
+  }
+
+  // 一个 JSON 对象，没有出现过的命令不输出
+  void report(std::FILE *file) const {
+    std::fputs("{\"commands\": {", file);
+    bool first = true;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+      const LatencyHistogram &h = histograms[i];
+      if (!h.count())
+        continue;
+      std::fprintf(file,
+                   "%s\"%s\": {\"count\": %llu, \"total_ns\": %llu, "
+                   "\"p50_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu}",
+                   first ? "" : ", ", names[i].c_str(),
+                   static_cast<unsigned long long>(h.count()),
+                   static_cast<unsigned long long>(h.total()),
+                   static_cast<unsigned long long>(h.percentile(0.5)),
+                   static_cast<unsigned long long>(h.percentile(0.99)),
+                   static_cast<unsigned long long>(h.max()));
+      first = false;
+    }
+    std::fputs("}, \"counters\": {", file);
+    first = true;
+    for (const auto &[name, val] : counters) {
+      std::fprintf(file, "%s\"%s\": %llu", first ? "" : ", ", name.c_str(),
+                   static_cast<unsigned long long>(val));
+      first = false;
+    }
+    std::fputs("}}", file);
+  }
+};
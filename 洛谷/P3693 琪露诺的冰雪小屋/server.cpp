@@ -0,0 +1,206 @@
+// 多局服务：在一个进程里同时跑很多局，省掉每局的启动和读入开销
+// 用法：./server [线程数]，从 stdin 读入多路复用的命令，每行一条：
+//   <id> NEW n hm hr hc hx hy   开一局
+//   <id> <命令>                 同 main.cpp 的命令，MAKE_ROOF 之后这局结束
+//   <id> CLOSE                  提前结束这一局
+// 每行回复都带上 <id> 前缀；同一局的回复保持顺序，不同局之间互不等待
+// 编译：g++ -std=c++20 -O2 -pthread server.cpp -o server
+
+#define WORLD_NO_MAIN
+#include "main.cpp"
+#include "thread_pool.hpp"
+
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+// 复用 World，避免每局重新分配网格
+class WorldPool {
+private:
+  std::mutex mutex;
+  std::vector<std::unique_ptr<World>> idle;
+  Writer silent{nullptr};
+
+public:
+  std::unique_ptr<World> acquire(int n, int hm, int hr, int hc, int hx,
+                                 int hy) {
+    std::unique_ptr<World> world;
+    {
+      std::lock_guard lock(mutex);
+      if (!idle.empty()) {
+        world = std::move(idle.back());
+        idle.pop_back();
+      }
+    }
+    if (world)
+      world->reset(n, hm, hr, hc, hx, hy);
+    else
+      world = std::make_unique<World>(n, hm, hr, hc, hx, hy, silent);
+    return world;
+  }
+
+  Writer &silentWriter() { return silent; }
+
+  void release(std::unique_ptr<World> world) {
+    world->setOutput(silent);
+    std::lock_guard lock(mutex);
+    idle.push_back(std::move(world));
+  }
+};
+
+class Server {
+private:
+  struct Session {
+    std::string id;
+    std::unique_ptr<World> world;
+    std::deque<std::string> pending; // 还没执行的命令
+    bool running = false;            // 是否已有任务在处理 pending
+  };
+
+  ThreadPool &pool;
+  WorldPool worlds;
+  std::mutex mutex; // 保护 sessions、runningCnt 和每局的 pending / running
+  std::condition_variable idle;
+  int runningCnt = 0; // 正在线程池上排队或执行的局数
+  std::unordered_map<std::string, std::shared_ptr<Session>> sessions;
+
+  std::mutex outMutex;
+  Writer out{stdout};
+
+  // 给每一行加上 id 前缀后整体写出
+  void emit(const std::string &id, std::string_view text) {
+    std::lock_guard lock(outMutex);
+    while (!text.empty()) {
+      const std::size_t pos = text.find('\n');
+      out << id << ' ' << text.substr(0, pos) << '\n';
+      if (pos == std::string_view::npos)
+        break;
+      text.remove_prefix(pos + 1);
+    }
+  }
+
+  // 在线程池上依次执行一局积压的命令，直到清空
+  void drain(const std::shared_ptr<Session> &session) {
+    std::string text;
+    Writer writer(text);
+    for (;;) {
+      std::string line;
+      {
+        std::lock_guard lock(mutex);
+        if (session->pending.empty()) {
+          session->running = false;
+          break;
+        }
+        line = std::move(session->pending.front());
+        session->pending.pop_front();
+      }
+      Reader in(line);
+      const std::string_view name = in.token();
+      if (name == "CLOSE") {
+        worlds.release(std::move(session->world));
+        continue;
+      }
+      const Opcode opcode = parseOpcode(name);
+      if (opcode == Opcode::UNKNOWN) {
+        emit(session->id, "ERROR UNKNOWN COMMAND");
+        continue;
+      }
+      // World 只用断言检查参数，越界的命令不能交给它
+      if (Reader args = in; !isValidCommand(*session->world, opcode, args)) {
+        emit(session->id, "ERROR INVALID ARGUMENT");
+        continue;
+      }
+      session->world->setOutput(writer);
+      runCommand(*session->world, opcode, in);
+      writer.flush();
+      emit(session->id, text);
+      text.clear();
+      if (opcode == Opcode::MAKE_ROOF)
+        worlds.release(std::move(session->world));
+      else
+        session->world->setOutput(worlds.silentWriter());
+    }
+    {
+      std::lock_guard lock(outMutex);
+      out.flush();
+    }
+    std::lock_guard lock(mutex);
+    if (!--runningCnt)
+      idle.notify_all();
+  }
+
+public:
+  explicit Server(ThreadPool &pool) : pool(pool) {}
+
+  // 由读入线程调用，只做路由，立即返回
+  void dispatch(std::string_view line) {
+    Reader in(line);
+    const std::string id(in.token());
+    if (id.empty())
+      return;
+    const std::string_view rest = line.substr(line.find(id) + id.size());
+    Reader cmd(rest);
+    const std::string_view name = cmd.token();
+    std::shared_ptr<Session> session;
+    {
+      std::lock_guard lock(mutex);
+      const auto iter = sessions.find(id);
+      if (name == "NEW") {
+        if (iter != sessions.end()) {
+          emit(id, "ERROR SESSION EXISTS");
+          return;
+        }
+        const int n = cmd.integer(), hm = cmd.integer();
+        const int hr = cmd.integer(), hc = cmd.integer();
+        const int hx = cmd.integer(), hy = cmd.integer();
+        if (!cmd.good() || !World::isValidShape(n, hm, hr, hc, hx, hy)) {
+          emit(id, "ERROR INVALID SHAPE");
+          return;
+        }
+        session = std::make_shared<Session>();
+        session->id = id;
+        session->world = worlds.acquire(n, hm, hr, hc, hx, hy);
+        sessions.emplace(id, std::move(session));
+        return;
+      }
+      if (iter == sessions.end()) {
+        emit(id, "ERROR NO SUCH SESSION");
+        return;
+      }
+      session = iter->second;
+      // 之后同一个 id 可以立即重新 NEW，这局剩下的命令照常执行完
+      if (name == "CLOSE" || name == "MAKE_ROOF")
+        sessions.erase(iter);
+      session->pending.emplace_back(rest);
+      if (session->running)
+        return;
+      session->running = true;
+      ++runningCnt;
+    }
+    pool.submit([this, session] { drain(session); });
+  }
+
+  // 等所有积压的命令执行完
+  void wait() {
+    std::unique_lock lock(mutex);
+    idle.wait(lock, [this] { return !runningCnt; });
+  }
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::ios::sync_with_stdio(false);
+  ThreadPool pool(argc > 1 ? std::atoi(argv[1])
+                           : std::max(1U, std::thread::hardware_concurrency()));
+  Server server(pool);
+  for (std::string line; std::getline(std::cin, line);)
+    server.dispatch(line);
+  server.wait();
+  return 0;
+}
@@ -0,0 +1,90 @@
+// 固定大小的线程池，给 planner 等离线工具用，main.cpp 本身不依赖它
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class ThreadPool {
+private:
+  std::vector<std::thread> workers;
+  std::queue<std::function<void()>> tasks;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stopping = false;
+
+public:
+  explicit ThreadPool(unsigned threadCnt = std::max(
+                          1U, std::thread::hardware_concurrency())) {
+    for (unsigned i = 0; i < threadCnt; ++i) {
+      workers.emplace_back([this] {
+        for (;;) {
+          std::function<void()> task;
+          {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+              return;
+            task = std::move(tasks.front());
+            tasks.pop();
+          }
+          task();
+        }
+      });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+    cv.notify_all();
+    for (std::thread &worker : workers)
+      worker.join();
+  }
+
+  unsigned size() const { return workers.size(); }
+
+  template <class F> std::future<std::invoke_result_t<F>> submit(F f) {
+    using R = std::invoke_result_t<F>;
+    auto task = std::make_shared<std::packaged_task<R()>>(std::move(f));
+    std::future<R> future = task->get_future();
+    {
+      std::lock_guard lock(mutex);
+      tasks.emplace([task] { (*task)(); });
+    }
+    cv.notify_one();
+    return future;
+  }
+
+  // 对 [0, count) 的每个 i 调用 f(i)，调用者线程也参与，全部完成后返回
+  // 不要在池内的任务里再调用 parallelFor
+  template <class F> void parallelFor(int count, F f) {
+    std::atomic<int> next = 0;
+    const auto run = [&] {
+      for (int i; (i = next++) < count;)
+        f(i);
+    };
+    std::vector<std::future<void>> futures;
+    const int helperCnt = std::min<int>(size(), count - 1);
+    for (int i = 0; i < helperCnt; ++i)
+      futures.push_back(submit(run));
+    run();
+    for (std::future<void> &future : futures)
+      future.get();
+  }
+};
@@ -0,0 +1,140 @@
+// 7 的自顶向下 alpha-beta：放的一方最小化，移的一方最大化总得分
+// 逆推要把所有局面都算一遍，这里只要证明答案，大部分子树都剪掉了
+//
+// 记忆化表存的是区间 [lower, upper]：窗口外失败时只知道一边
+// 根上用零宽窗口反复试探（MTD(f)），比一次全窗口搜索剪得多
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "instrument.hpp"
+#include "memo.hpp"
+#include "shape.hpp"
+
+template <class S> class AlphaBetaSolver {
+public:
+  using Key = typename S::Key;
+  using Value = long long;
+
+  struct Stats {
+    std::uint64_t placeNodes = 0, moveNodes = 0; // 展开的结点
+    std::uint64_t memoHits = 0;                  // 记忆化的区间直接给出了结果
+  };
+
+private:
+  static constexpr Value INF = std::numeric_limits<Value>::max() / 4;
+
+  struct Bound {
+    Value lower, upper;
+  };
+
+  HashMemo<Bound, Key> placeMemo, moveMemo; // 先手放 / 先手移
+  Stats stats;
+
+  // 查表收窄窗口；已经能给出结果时返回 true
+  bool probe(HashMemo<Bound, Key> &memo, Key state, Value &alpha,
+             Value &beta, Value &value) {
+    const Bound *p = memo.find(state);
+    if (!p)
+      return false;
+    if (p->lower >= beta || p->upper <= alpha || p->lower == p->upper) {
+      ++stats.memoHits;
+      value = p->lower >= beta ? p->lower : p->upper;
+      return true;
+    }
+    alpha = std::max(alpha, p->lower);
+    beta = std::min(beta, p->upper);
+    return false;
+  }
+
+  // 在窗口 (alpha, beta) 里搜出的 value 写回去
+  static void store(HashMemo<Bound, Key> &memo, Key state, Value alpha,
+                    Value beta, Value value) {
+    const Bound *p = memo.find(state);
+    Bound bound = p ? *p : Bound{0, INF};
+    if (value > alpha)
+      bound.lower = std::max(bound.lower, value);
+    if (value < beta)
+      bound.upper = std::min(bound.upper, value);
+    memo.insert(state, bound);
+  }
+
+  // 先手放：对手挑最坏的格子和数字
+  Value placeValue(Key state, Value alpha, Value beta) {
+    state = S::getUniqueState(state);
+    Value value;
+    if (probe(placeMemo, state, alpha, beta, value))
+      return value;
+    ++stats.placeNodes;
+    instrument::count(instrument::PLACE_CALLS);
+    value = INF;
+    Value window = beta;
+    for (unsigned i = 0; i < S::CELLS && value > alpha; ++i) {
+      if (S::getCell(state, i))
+        continue;
+      for (unsigned v : {1, 2}) {
+        value =
+            std::min(value, moveValue(S::place(state, i, v), alpha, window));
+        window = std::min(window, value);
+        if (value <= alpha)
+          break;
+      }
+    }
+    store(placeMemo, state, alpha, beta, value);
+    return value;
+  }
+
+  // 先手移：得分高的方向先试，容易早点超过 beta
+  Value moveValue(Key state, Value alpha, Value beta) {
+    state = S::getUniqueState(state);
+    Value value;
+    if (probe(moveMemo, state, alpha, beta, value))
+      return value;
+    ++stats.moveNodes;
+    instrument::count(instrument::MOVE_CALLS);
+    typename S::Move moves[4];
+    unsigned cnt = 0;
+    for (unsigned d = 0; d < 4; ++d) {
+      const typename S::Move p = S::move(d, state);
+      if (p.board != state)
+        moves[cnt++] = p;
+    }
+    std::stable_sort(moves, moves + cnt,
+                     [](const typename S::Move &a, const typename S::Move &b) {
+                       return a.score > b.score;
+                     });
+    value = 0;
+    for (unsigned k = 0; k < cnt && value < beta; ++k) {
+      const Value score = moves[k].score;
+      value = std::max(value, score + placeValue(moves[k].board,
+                                                 std::max(alpha, value) - score,
+                                                 beta - score));
+    }
+    store(moveMemo, state, alpha, beta, value);
+    return value;
+  }
+
+public:
+  // 空局面上先连放两块；值都是整数，窗口 (g - 1, g) 只回答“是否不小于 g”
+  // MTD(f)：从 0 开始猜，每次用零宽窗口把区间 [lower, upper] 缩一边，
+  // 记忆化表里的区间在各次搜索之间共用
+  Value solve() {
+    Value lower = 0, upper = INF, value = 0;
+    while (lower < upper) {
+      const Value beta = value == lower ? value + 1 : value;
+      value = INF;
+      for (unsigned i = 0; i < S::CELLS && value >= beta; ++i) {
+        for (unsigned v : {1, 2})
+          value =
+              std::min(value, placeValue(S::place(0, i, v), beta - 1, beta));
+      }
+      (value < beta ? upper : lower) = value;
+    }
+    return value;
+  }
+
+  const Stats &getStats() const { return stats; }
+};
@@ -0,0 +1,23 @@
+// 由 gen_answers.cpp 生成，不要手改
+
+#pragma once
+
+constexpr unsigned long ANSWER_7 = 164UL;
+
+// 下标是 target，超过的都是 0
+constexpr double ANSWER_8[] = {
+    0x1p+0,
+    0x1p+0,
+    0x1p+0,
+    0x1p+0,
+    0x1p+0,
+    0x1p+0,
+    0x1p+0,
+    0x1.fffff97cbccb4p-1,
+    0x1.fdcda783b3917p-1,
+    0x1.793a7705b41e6p-1,
+    0x1.7385081488bb4p-7,
+    0x0p+0,
+};
+
+constexpr double ANSWER_9 = 0x1.55c7c9ec14d04p+12;
@@ -0,0 +1,219 @@
+// 7.cpp、8.cpp、9.cpp 共用的 3x3 局面和移动
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstdint>
+
+struct State {
+  unsigned char data[3][3];
+
+  auto operator<=>(const State &other) const = default;
+};
+
+// 压缩的局面：每格存指数，5 位足够（3x3 上最大只能合出 2^11 左右）
+// (i, j) 在第 5 * (3 * i + j) 位起的 5 位，第 i 行是连续的 15 位
+using Board = std::uint64_t;
+
+constexpr unsigned CELL_BITS = 5;
+constexpr unsigned LINE_BITS = 3 * CELL_BITS;
+constexpr Board CELL_MASK = (Board(1) << CELL_BITS) - 1;
+constexpr Board LINE_MASK = (Board(1) << LINE_BITS) - 1;
+
+constexpr unsigned getCell(Board board, unsigned pos) {
+  return board >> (CELL_BITS * pos) & CELL_MASK;
+}
+
+constexpr Board pack(const State &state) {
+  Board board = 0;
+  for (unsigned short i = 0; i < 3; ++i) {
+    for (unsigned short j = 0; j < 3; ++j)
+      board |= Board(state.data[i][j]) << (CELL_BITS * (3 * i + j));
+  }
+  return board;
+}
+
+constexpr State unpack(Board board) {
+  State state{};
+  for (unsigned short i = 0; i < 3; ++i) {
+    for (unsigned short j = 0; j < 3; ++j)
+      state.data[i][j] = getCell(board, 3 * i + j);
+  }
+  return state;
+}
+
+constexpr unsigned getMax(Board board) {
+  unsigned answer = 0;
+  for (unsigned i = 0; i < 9; ++i)
+    answer = std::max(answer, getCell(board, i));
+  return answer;
+}
+
+// 数字和的一半：指数为 v 的格子贡献 2^(v - 1)
+constexpr unsigned getLayer(Board board) {
+  unsigned sum = 0;
+  for (unsigned i = 0; i < 9; ++i) {
+    if (getCell(board, i))
+      sum += 1U << (getCell(board, i) - 1);
+  }
+  return sum;
+}
+
+constexpr Board mirrorHorizontally(Board board) {
+  constexpr Board COLUMN0 = CELL_MASK | CELL_MASK << LINE_BITS |
+                            CELL_MASK << (2 * LINE_BITS);
+  return (board & COLUMN0 << CELL_BITS) |
+         (board & COLUMN0) << (2 * CELL_BITS) |
+         (board >> (2 * CELL_BITS) & COLUMN0);
+}
+
+constexpr Board mirrorVertically(Board board) {
+  return (board & LINE_MASK << LINE_BITS) |
+         (board & LINE_MASK) << (2 * LINE_BITS) |
+         (board >> (2 * LINE_BITS) & LINE_MASK);
+}
+
+// 沿主对角线翻转：(0, 1) <-> (1, 0)、(1, 2) <-> (2, 1) 相差 2 格，
+// (0, 2) <-> (2, 0) 相差 4 格，对角线不动
+constexpr Board transpose(Board board) {
+  constexpr Board DIAGONAL =
+      CELL_MASK | CELL_MASK << (4 * CELL_BITS) | CELL_MASK << (8 * CELL_BITS);
+  constexpr Board NEAR = CELL_MASK << CELL_BITS | CELL_MASK << (5 * CELL_BITS);
+  constexpr Board FAR = CELL_MASK << (2 * CELL_BITS);
+  return (board & DIAGONAL) | (board & NEAR) << (2 * CELL_BITS) |
+         (board >> (2 * CELL_BITS) & NEAR) | (board & FAR) << (4 * CELL_BITS) |
+         (board >> (4 * CELL_BITS) & FAR);
+}
+
+// 正方形的 8 个对称（二面体群 D4）里取最小的表示
+// 两个镜像生成 4 个，再各自转置得到另外 4 个（旋转和两条对角线翻转）
+constexpr Board getUniqueState(Board board) {
+  Board answer = board;
+  for (Board t : {board, transpose(board)}) {
+    const Board h = mirrorHorizontally(t);
+    answer = std::min({answer, t, h, mirrorVertically(t),
+                       mirrorVertically(h)});
+  }
+  return answer;
+}
+
+// 一行（或一列）三格压成 15 位，预先算好往下标 0 一侧滑动的结果
+// 往另一侧滑动就是把行反过来查同一张表
+struct LineMove {
+  std::uint16_t line;  // 滑动后的行
+  std::uint32_t score; // 合并得分
+};
+
+// 长为 length 的一行往下标 0 一侧滑动，返回滑动后的行，score 是合并得分
+// 别的形状（shape.hpp）也用它建表，BITS 是每格的位数
+template <unsigned BITS = CELL_BITS>
+constexpr unsigned slideLine(unsigned line, unsigned length,
+                             unsigned &score) {
+  constexpr unsigned MASK = (1U << BITS) - 1;
+  unsigned v[8] = {}, size = 0;
+  bool flag = false;
+  score = 0;
+  for (unsigned i = 0; i < length; ++i) {
+    const unsigned cell = line >> (BITS * i) & MASK;
+    if (!cell)
+      continue;
+    if (flag && cell == v[size - 1]) {
+      // 装不下的指数不会出现（或者极少出现），截断只是为了让表是完整的
+      v[size - 1] = std::min(v[size - 1] + 1, MASK);
+      score += 1U << v[size - 1];
+      flag = false;
+    } else {
+      v[size++] = cell;
+      flag = true;
+    }
+  }
+  unsigned result = 0;
+  for (unsigned i = 0; i < size; ++i)
+    result |= v[i] << (BITS * i);
+  return result;
+}
+
+constexpr std::array<LineMove, 1 << LINE_BITS> makeLineTable() {
+  std::array<LineMove, 1 << LINE_BITS> table{};
+  for (unsigned line = 0; line < table.size(); ++line) {
+    unsigned score = 0;
+    const unsigned result = slideLine(line, 3, score);
+    table[line] = {static_cast<std::uint16_t>(result), score};
+  }
+  return table;
+}
+
+inline constexpr std::array<LineMove, 1 << LINE_BITS> LINE_TABLE =
+    makeLineTable();
+
+constexpr unsigned reverseLine(unsigned line) {
+  return (line & CELL_MASK << CELL_BITS) | (line & CELL_MASK) << 2 * CELL_BITS |
+         line >> 2 * CELL_BITS;
+}
+
+constexpr unsigned getRow(Board board, unsigned i) {
+  return board >> (LINE_BITS * i) & LINE_MASK;
+}
+
+constexpr unsigned getColumn(Board board, unsigned j) {
+  return getCell(board, j) | getCell(board, 3 + j) << CELL_BITS |
+         getCell(board, 6 + j) << (2 * CELL_BITS);
+}
+
+constexpr Board spreadColumn(unsigned line, unsigned j) {
+  return (Board(line & CELL_MASK) |
+          Board(line >> CELL_BITS & CELL_MASK) << LINE_BITS |
+          Board(line >> (2 * CELL_BITS)) << (2 * LINE_BITS))
+         << (CELL_BITS * j);
+}
+
+// 一次移动的结果；score 是这一步的合并得分
+struct Move {
+  Board board;
+  std::uint32_t score;
+};
+
+constexpr Move moveLeft(Board board) {
+  Move move{0, 0};
+  for (unsigned i = 0; i < 3; ++i) {
+    const LineMove &line = LINE_TABLE[getRow(board, i)];
+    move.board |= Board(line.line) << (LINE_BITS * i);
+    move.score += line.score;
+  }
+  return move;
+}
+
+constexpr Move moveRight(Board board) {
+  Move move{0, 0};
+  for (unsigned i = 0; i < 3; ++i) {
+    const LineMove &line = LINE_TABLE[reverseLine(getRow(board, i))];
+    move.board |= Board(reverseLine(line.line)) << (LINE_BITS * i);
+    move.score += line.score;
+  }
+  return move;
+}
+
+constexpr Move moveUpwards(Board board) {
+  Move move{0, 0};
+  for (unsigned j = 0; j < 3; ++j) {
+    const LineMove &line = LINE_TABLE[getColumn(board, j)];
+    move.board |= spreadColumn(line.line, j);
+    move.score += line.score;
+  }
+  return move;
+}
+
+constexpr Move moveDownwards(Board board) {
+  Move move{0, 0};
+  for (unsigned j = 0; j < 3; ++j) {
+    const LineMove &line = LINE_TABLE[reverseLine(getColumn(board, j))];
+    move.board |= spreadColumn(reverseLine(line.line), j);
+    move.score += line.score;
+  }
+  return move;
+}
+
+constexpr Move (*const MOVES[4])(Board) = {moveUpwards, moveDownwards,
+                                           moveLeft, moveRight};
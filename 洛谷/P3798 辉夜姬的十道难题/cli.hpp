@@ -0,0 +1,77 @@
+// variants、montecarlo 等命令行工具共用的参数解析和棋盘形状的分派
+
+#pragma once
+
+#include <cstdlib>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+#include "rules.hpp"
+#include "shape.hpp"
+
+// 非负整数参数（随机种子等）：整个串都是数字、不溢出 T
+// 不是时返回 false，value 不变
+template <class T> bool parseUnsigned(const char *arg, T &value) {
+  if (!*arg)
+    return false;
+  T x = 0;
+  for (const char *p = arg; *p; ++p) {
+    if (*p < '0' || *p > '9')
+      return false;
+    const T digit = *p - '0';
+    if (x > (std::numeric_limits<T>::max() - digit) / 10)
+      return false;
+    x = x * 10 + digit;
+  }
+  value = x;
+  return true;
+}
+
+// 正整数参数（线程数、局数等）：同上，另外不为 0
+template <class T> bool parsePositive(const char *arg, T &value) {
+  T x;
+  if (!parseUnsigned(arg, x) || !x)
+    return false;
+  value = x;
+  return true;
+}
+
+// [0, 1] 里的概率：整个串是一个实数；不是时返回 false，value 不变
+inline bool parseProbability(const char *arg, double &value) {
+  char *end;
+  const double x = std::strtod(arg, &end);
+  if (end == arg || *end || !(x >= 0 && x <= 1))
+    return false;
+  value = x;
+  return true;
+}
+
+// 8 的 target：1 到 BasicReachDistribution<S>::MAX_TARGET 之间的整数，
+// 更大的 2^target 在 S 上合不出来；不是时返回 false，target 不变
+template <class S> bool parseTarget(const char *arg, unsigned &target) {
+  unsigned t;
+  if (!parsePositive(arg, t) || t > BasicReachDistribution<S>::MAX_TARGET)
+    return false;
+  target = t;
+  return true;
+}
+
+// variants、montecarlo 认得的棋盘形状，名字是 Shape::name() 的 "NxM"
+template <class... S> struct ShapeList {};
+using CliShapes =
+    ShapeList<Shape<2, 2>, Shape<2, 3>, Shape<2, 4>, Shape<3, 2>, Shape<3, 3>,
+              Shape<3, 4>, Shape<4, 2>, Shape<4, 3>, Shape<4, 4>>;
+
+// 名字对得上时调用 f(std::type_identity<Shape<N, M>>{}) 并返回它的结果，
+// 都对不上时返回 -1
+template <class F, class... S>
+int dispatchShape(std::string_view name, F f, ShapeList<S...>) {
+  int result = -1;
+  ((name == S::name() && (result = f(std::type_identity<S>{}), true)) || ...);
+  return result;
+}
+
+template <class F> int dispatchShape(std::string_view name, F f) {
+  return dispatchShape(name, f, CliShapes{});
+}
@@ -0,0 +1,203 @@
+// 7.cpp、8.cpp、9.cpp 共用的命令行：
+//   [threads]       逆推用的线程数，默认是硬件线程数；别的参数都是选项，
+//                   认不出来时输出用法并失败
+//   --save FILE     逆推的同时把每层的表写进 FILE（见 table.hpp）
+//   --load FILE     不再逆推，mmap 之前存下的表直接给出答案
+//   --policy FILE   逆推的同时把每个先手移局面的最优方向写进 FILE
+//   --query         从标准输入读局面，每个局面按行给出各格的数（0 是空格），
+//                   每行输出 “最优方向 值”；有 --load 时先查表，
+//                   查不到的现算（见 query.hpp）
+//   --topdown       改用多线程的自顶向下搜索（见 parallel.hpp），
+//                   先枚举可达局面建完美哈希，值存在按编号排的数组里；
+//                   不能和 --save、--policy 一起用
+// 用 -DSOLVER_STATS 编译时，结束前把计数器的报告输出到标准错误
+// （见 instrument.hpp）
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+#include "cli.hpp"
+#include "instrument.hpp"
+#include "parallel.hpp"
+#include "query.hpp"
+#include "retrograde.hpp"
+#include "table.hpp"
+
+// 读一个数字，0 是空格；不是 2 的幂就失败
+inline bool readTile(std::istream &in, unsigned &exponent) {
+  unsigned long tile;
+  if (!(in >> tile))
+    return false;
+  if (tile & (tile - 1) || tile == 1 || tile > 1UL << CELL_MASK)
+    return false;
+  exponent = 0;
+  while (tile > 1) {
+    tile >>= 1;
+    ++exponent;
+  }
+  return true;
+}
+
+template <class Rules, class Print>
+int runQueries(const Rules &rules, const char *loadPath, Print print) {
+  std::optional<MappedTable<Rules>> table;
+  if (loadPath) {
+    table.emplace(loadPath, rules);
+    if (!table->isOpen()) {
+      std::cerr << "cannot load " << loadPath << " as " << rules.describe()
+                << '\n';
+      return 1;
+    }
+  }
+  PositionQuery<Rules> query(rules, table ? &*table : nullptr);
+  std::ios::sync_with_stdio(false);
+  std::size_t queryCnt = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (;; ++queryCnt) {
+    using Shape = typename Rules::Shape;
+    typename Rules::Key state = 0;
+    unsigned exponent;
+    if (!readTile(std::cin, exponent))
+      break;
+    state = Shape::place(state, 0, exponent);
+    for (unsigned i = 1; i < Shape::CELLS; ++i) {
+      if (!readTile(std::cin, exponent)) {
+        std::cerr << "bad board #" << queryCnt + 1 << '\n';
+        return 1;
+      }
+      state = Shape::place(state, i, exponent);
+    }
+    const auto answer = query.query(state);
+    std::cout << MOVE_NAMES[answer.move] << ' ';
+    print(answer.value);
+  }
+  if (!std::cin.eof()) {
+    std::cerr << "bad board #" << queryCnt + 1 << '\n';
+    return 1;
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cerr << queryCnt << " queries in " << elapsed.count() << " s, "
+            << query.getMemoSize() << " states solved on demand\n";
+  return 0;
+}
+
+inline std::FILE *openOutput(const char *path) {
+  std::FILE *file = path ? std::fopen(path, "wb") : nullptr;
+  if (path && !file)
+    std::cerr << "cannot open " << path << '\n';
+  return file;
+}
+
+inline bool closeOutput(const char *path, std::FILE *file, bool ok) {
+  if (!file)
+    return true;
+  if (std::fclose(file) || !ok) {
+    std::cerr << "cannot write " << path << '\n';
+    return false;
+  }
+  return true;
+}
+
+// print(answer) 负责输出一个值并换行；出错时返回非 0
+template <class Rules, class Print>
+int runSolver(const Rules &rules, int argc, char **argv, Print print) {
+  const instrument::ReportOnExit report;
+  using Key = typename Rules::Key;
+  using Value = typename Rules::Value;
+  unsigned threadCnt = std::thread::hardware_concurrency();
+  const char *savePath = nullptr, *loadPath = nullptr, *policyPath = nullptr;
+  bool queryMode = false, topDown = false;
+  for (int i = 0; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--save") && i + 1 < argc)
+      savePath = argv[++i];
+    else if (!std::strcmp(argv[i], "--load") && i + 1 < argc)
+      loadPath = argv[++i];
+    else if (!std::strcmp(argv[i], "--policy") && i + 1 < argc)
+      policyPath = argv[++i];
+    else if (!std::strcmp(argv[i], "--query"))
+      queryMode = true;
+    else if (!std::strcmp(argv[i], "--topdown"))
+      topDown = true;
+    else if (!parsePositive(argv[i], threadCnt)) {
+      std::cerr << "bad argument " << argv[i]
+                << "\noptions: [threads] [--save FILE] [--load FILE] "
+                   "[--policy FILE] [--query] [--topdown]\n";
+      return 1;
+    }
+  }
+
+  if (queryMode) {
+    if constexpr (std::is_arithmetic_v<Value>) {
+      return runQueries(rules, loadPath, print);
+    } else {
+      std::cerr << rules.describe() << " does not support --query\n";
+      return 1;
+    }
+  }
+
+  if (loadPath) {
+    const MappedTable<Rules> table(loadPath, rules);
+    if (!table.isOpen()) {
+      std::cerr << "cannot load " << loadPath << " as " << rules.describe()
+                << '\n';
+      return 1;
+    }
+    print(table.answer());
+    return 0;
+  }
+
+  if (topDown) {
+    if (savePath || policyPath) {
+      std::cerr << "--topdown cannot be used with --save or --policy\n";
+      return 1;
+    }
+    ParallelSolver<Rules> solver(rules, threadCnt);
+    print(solver.solve());
+    std::cerr << solver.getStateCnt() << " states\n";
+    return 0;
+  }
+
+  if (!std::is_arithmetic_v<Value> && policyPath) {
+    std::cerr << rules.describe() << " does not support --policy\n";
+    return 1;
+  }
+  std::FILE *saveFile = openOutput(savePath);
+  std::FILE *policyFile = openOutput(policyPath);
+  if ((savePath && !saveFile) || (policyPath && !policyFile))
+    return 1;
+  std::optional<TableWriter<Rules>> saver;
+  if (saveFile)
+    saver.emplace(saveFile, rules);
+  std::optional<PolicyWriter<Rules>> policy;
+  if (policyFile)
+    policy.emplace(policyFile, rules);
+
+  RetrogradeSolver<Rules> solver(rules, threadCnt);
+  const Value answer = solver.solve(
+      [&](std::size_t s, const std::vector<Key> &toPlace,
+          const std::vector<Value> &placeValues,
+          const std::vector<Key> &toMove,
+          const std::vector<Value> &moveValues) {
+        if (saver)
+          (*saver)(s, toPlace, placeValues, toMove, moveValues);
+        if constexpr (std::is_arithmetic_v<Value>) {
+          if (policy)
+            (*policy)(s, toPlace, placeValues, toMove, moveValues);
+        }
+      });
+  const bool saved = closeOutput(savePath, saveFile, !saver || saver->finish());
+  const bool exported =
+      closeOutput(policyPath, policyFile, !policy || policy->finish());
+  if (!saved || !exported)
+    return 1;
+  print(answer);
+  return 0;
+}
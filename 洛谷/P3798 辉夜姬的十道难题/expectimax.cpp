@@ -0,0 +1,83 @@
+// 用 expectimax.hpp 在 4x4 上玩随机放块的 2048，统计得分和搜索速度
+// 用法：./expectimax [depth] [budgetMs] [minProbability] [games] [seed]
+// depth 在 1 到 255 之间（置换表里存 8 位），games 是正整数，
+// budgetMs 和 seed 是非负整数（第一层总会搜完），minProbability 在 [0, 1] 里
+// 每局一行 JSON，最后一行是总计
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "cli.hpp"
+#include "expectimax.hpp"
+#include "shape.hpp"
+
+using Bitboard = Shape<4, 4, 4>;
+
+// 随机挑一个空格放 2（0.9）或 4（0.1）
+Bitboard::Key placeRandom(Bitboard::Key state, std::mt19937_64 &rng) {
+  unsigned empty[Bitboard::CELLS], cnt = 0;
+  for (unsigned i = 0; i < Bitboard::CELLS; ++i) {
+    if (!Bitboard::getCell(state, i))
+      empty[cnt++] = i;
+  }
+  const unsigned pos = empty[rng() % cnt];
+  return Bitboard::place(state, pos, rng() % 10 ? 1 : 2);
+}
+
+int main(int argc, char **argv) {
+  Expectimax<Bitboard>::Limits limits;
+  unsigned budget = limits.budget.count(), games = 1;
+  std::uint64_t seed = 20220323;
+  if ((argc > 1 && (!parsePositive(argv[1], limits.depth) ||
+                    limits.depth > UINT8_MAX)) ||
+      (argc > 2 && !parseUnsigned(argv[2], budget)) ||
+      (argc > 3 && !parseProbability(argv[3], limits.minProbability)) ||
+      (argc > 4 && !parsePositive(argv[4], games)) ||
+      (argc > 5 && !parseUnsigned(argv[5], seed))) {
+    std::fprintf(stderr,
+                 "usage: %s [depth] [budgetMs] [minProbability] [games] "
+                 "[seed]\n",
+                 argv[0]);
+    return 1;
+  }
+  limits.budget = std::chrono::milliseconds(budget);
+  std::mt19937_64 rng(seed);
+
+  Expectimax<Bitboard> search;
+  std::uint64_t totalNodes = 0, totalScore = 0;
+  double totalSeconds = 0;
+  for (unsigned game = 0; game < games; ++game) {
+    Bitboard::Key state = placeRandom(placeRandom(0, rng), rng);
+    std::uint64_t score = 0, nodes = 0, depthSum = 0;
+    unsigned moves = 0;
+    double seconds = 0;
+    for (;;) {
+      const auto report = search.search(state, limits);
+      nodes += report.nodes;
+      seconds += report.seconds;
+      if (report.move == 4)
+        break;
+      const Bitboard::Move p = Bitboard::move(report.move, state);
+      score += p.score;
+      depthSum += report.depth;
+      ++moves;
+      state = placeRandom(p.board, rng);
+    }
+    totalNodes += nodes;
+    totalScore += score;
+    totalSeconds += seconds;
+    std::printf("{\"game\":%u,\"score\":%llu,\"maxTile\":%u,\"moves\":%u,"
+                "\"meanDepth\":%.2f,\"nodesPerSecond\":%.0f}\n",
+                game, static_cast<unsigned long long>(score),
+                1U << Bitboard::getMax(state), moves,
+                moves ? double(depthSum) / moves : 0.0, nodes / seconds);
+  }
+  std::printf("{\"games\":%u,\"meanScore\":%.1f,\"nodes\":%llu,"
+              "\"seconds\":%.2f,\"nodesPerSecond\":%.0f}\n",
+              games, double(totalScore) / games,
+              static_cast<unsigned long long>(totalNodes), totalSeconds,
+              totalNodes / totalSeconds);
+  return 0;
+}
@@ -0,0 +1,223 @@
+// 大棋盘（比如 4x4）穷举不了，改成限深的期望最大搜索
+// 结构和逆推一样：placeValue 是随机放（期望），moveValue 是挑方向（最大），
+// 目标是 9 的总得分；到了深度或者走到这里的概率太小就用估值代替
+//
+// - 置换表：定长，按键的哈希直接映射；同一次搜索里深的结果不会被浅的覆盖，
+//   上一次搜索留下的条目随便覆盖；forget() 之后以前的条目都当作不存在
+// - 迭代加深：深度从 1 往上加，超时就用上一层完整的结果；深度 1 不看时间
+// - 估值：每行每列查一张预先算好的表（空格、可合并、单调性、数字大小）
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "memo.hpp"
+#include "shape.hpp"
+
+// 长为 L 的一行的估值表；权重是经验值
+template <unsigned L, unsigned CELL> struct LineHeuristic {
+  static constexpr double LOST_PENALTY = 200000;
+  static constexpr double MONOTONICITY_POWER = 4;
+  static constexpr double MONOTONICITY_WEIGHT = 47;
+  static constexpr double SUM_POWER = 3.5;
+  static constexpr double SUM_WEIGHT = 11;
+  static constexpr double MERGES_WEIGHT = 700;
+  static constexpr double EMPTY_WEIGHT = 270;
+
+  static std::vector<float> makeTable() {
+    std::vector<float> table(std::size_t(1) << (CELL * L));
+    for (unsigned line = 0; line < table.size(); ++line) {
+      unsigned v[L];
+      for (unsigned i = 0; i < L; ++i)
+        v[i] = line >> (CELL * i) & ((1U << CELL) - 1);
+      double sum = 0;
+      unsigned empty = 0, merges = 0, prev = 0, run = 0;
+      for (unsigned i = 0; i < L; ++i) {
+        sum += std::pow(v[i], SUM_POWER);
+        if (!v[i]) {
+          ++empty;
+          continue;
+        }
+        if (v[i] == prev) {
+          ++run;
+        } else {
+          if (run)
+            merges += run + 1;
+          prev = v[i];
+          run = 0;
+        }
+      }
+      if (run)
+        merges += run + 1;
+      double left = 0, right = 0;
+      for (unsigned i = 1; i < L; ++i) {
+        const double a = std::pow(v[i - 1], MONOTONICITY_POWER);
+        const double b = std::pow(v[i], MONOTONICITY_POWER);
+        if (v[i - 1] > v[i])
+          left += a - b;
+        else
+          right += b - a;
+      }
+      table[line] = LOST_PENALTY + EMPTY_WEIGHT * empty +
+                    MERGES_WEIGHT * merges -
+                    MONOTONICITY_WEIGHT * std::min(left, right) -
+                    SUM_WEIGHT * sum;
+    }
+    return table;
+  }
+
+  inline static const std::vector<float> TABLE = makeTable();
+};
+
+template <class S> class Expectimax {
+public:
+  using Key = typename S::Key;
+
+  struct Limits {
+    unsigned depth = 3;                    // 最多看几步移动
+    double minProbability = 1e-4;          // 走到这里的概率更小就直接估值
+    std::chrono::milliseconds budget{100}; // 每步的时间
+  };
+
+  struct Report {
+    std::uint8_t move; // 4 表示哪个方向都动不了
+    double value;
+    unsigned depth;      // 完整搜完的深度
+    std::uint64_t nodes; // 包括没搜完的那一层
+    double seconds;
+  };
+
+private:
+  struct Entry {
+    Key key;
+    float value;
+    std::uint8_t depth, generation;
+    std::uint16_t epoch; // 和 this->epoch 不同的条目都作废
+  };
+
+  static constexpr Key EMPTY = ~Key(0);
+
+  std::vector<Entry> table;
+  std::uint8_t generation = 0;
+  std::uint16_t epoch = 0;
+  double minProbability = 0;
+  std::uint64_t nodes = 0;
+  std::chrono::steady_clock::time_point deadline;
+  bool checkTime = false, aborted = false;
+
+  static double evaluate(Key state) {
+    using Row = LineHeuristic<S::COLUMNS, S::CELL_WIDTH>;
+    using Column = LineHeuristic<S::ROWS, S::CELL_WIDTH>;
+    double value = 0;
+    for (unsigned i = 0; i < S::ROWS; ++i)
+      value += Row::TABLE[S::getRow(state, i)];
+    for (unsigned j = 0; j < S::COLUMNS; ++j)
+      value += Column::TABLE[S::getColumn(state, j)];
+    return value;
+  }
+
+  Entry &slot(Key state) {
+    return table[hashKey(state) & (table.size() - 1)];
+  }
+
+  // 随机放：空格等概率，2 和 4 的概率是 0.9 和 0.1
+  double placeValue(Key state, unsigned depth, double probability) {
+    if (!depth || probability < minProbability)
+      return evaluate(state);
+    Entry &entry = slot(state);
+    if (entry.key == state && entry.epoch == epoch && entry.depth >= depth)
+      return entry.value;
+    unsigned cnt = 0;
+    for (unsigned i = 0; i < S::CELLS; ++i)
+      cnt += !S::getCell(state, i);
+    if (!cnt)
+      return evaluate(state);
+    double value = 0;
+    for (unsigned i = 0; i < S::CELLS && !aborted; ++i) {
+      if (S::getCell(state, i))
+        continue;
+      value += moveValue(S::place(state, i, 1), depth,
+                         probability * 0.9 / cnt) *
+               0.9;
+      value += moveValue(S::place(state, i, 2), depth,
+                         probability * 0.1 / cnt) *
+               0.1;
+    }
+    value /= cnt;
+    if (!aborted && (entry.epoch != epoch || entry.generation != generation ||
+                     entry.depth <= depth))
+      entry = {state, static_cast<float>(value),
+               static_cast<std::uint8_t>(depth), generation, epoch};
+    return value;
+  }
+
+  // 挑方向：这一步的合并得分加上之后的期望；动不了就是 0
+  double moveValue(Key state, unsigned depth, double probability) {
+    if ((++nodes & 1023) == 0 && checkTime &&
+        std::chrono::steady_clock::now() > deadline)
+      aborted = true;
+    if (aborted)
+      return 0;
+    double value = 0;
+    for (unsigned d = 0; d < 4; ++d) {
+      const typename S::Move p = S::move(d, state);
+      if (p.board != state)
+        value = std::max(value,
+                         p.score + placeValue(p.board, depth - 1, probability));
+    }
+    return value;
+  }
+
+public:
+  // 置换表 2^tableBits 项
+  explicit Expectimax(unsigned tableBits = 20)
+      : table(std::size_t(1) << tableBits, {EMPTY, 0, 0, 0, 0}) {}
+
+  // 以后的搜索不再用表里已有的结果，比如换了一局；
+  // 只换一个标记，epoch 转了一圈时才真的清空
+  void forget() {
+    if (!++epoch)
+      std::fill(table.begin(), table.end(), Entry{EMPTY, 0, 0, 0, 0});
+  }
+
+  Report search(Key state, const Limits &limits) {
+    const auto start = std::chrono::steady_clock::now();
+    deadline = start + limits.budget;
+    minProbability = limits.minProbability;
+    ++generation;
+    nodes = 0;
+    Report report{4, 0, 0, 0, 0};
+    for (unsigned depth = 1; depth <= limits.depth; ++depth) {
+      checkTime = depth > 1;
+      aborted = false;
+      std::uint8_t best = 4;
+      double bestValue = 0;
+      for (std::uint8_t d = 0; d < 4 && !aborted; ++d) {
+        const typename S::Move p = S::move(d, state);
+        if (p.board == state)
+          continue;
+        const double value = p.score + placeValue(p.board, depth - 1, 1);
+        if (best == 4 || bestValue < value) {
+          best = d;
+          bestValue = value;
+        }
+      }
+      if (aborted)
+        break;
+      report.move = best;
+      report.value = bestValue;
+      report.depth = depth;
+      if (best == 4)
+        break;
+    }
+    report.nodes = nodes;
+    report.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    return report;
+  }
+};
@@ -0,0 +1,79 @@
+// 生成 answers.hpp：三道题的答案在这里算好，7.cpp、8.cpp、9.cpp
+// 加 -DBAKED_ANSWERS 编译时直接输出，运行时不再搜索
+// 用法：./gen_answers [threads] > answers.hpp
+//       ./gen_answers check [threads]
+//         和现场算的结果逐位比较，需要编译时 answers.hpp 已经存在
+// 浮点数用十六进制写出，读回来逐位不变
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <thread>
+
+#include "retrograde.hpp"
+#include "rules.hpp"
+
+#if __has_include("answers.hpp")
+#include "answers.hpp"
+#define HAS_ANSWERS
+#endif
+
+struct Answers {
+  unsigned long answer7;
+  double answer8[ReachDistribution::MAX_TARGET + 1];
+  double answer9;
+};
+
+Answers solveAll(unsigned threadCnt) {
+  Answers answers{};
+  answers.answer7 = RetrogradeSolver<MinPlacementScore>({}, threadCnt).solve();
+  const ReachDistribution::Value p =
+      RetrogradeSolver<ReachDistribution>({}, threadCnt).solve();
+  answers.answer8[0] = 1; // 2^0 不用合，和 ReachProbability{0} 一致
+  for (unsigned t = 1; t <= ReachDistribution::MAX_TARGET; ++t)
+    answers.answer8[t] = p.p[t];
+  answers.answer9 = RetrogradeSolver<ExpectedScore>({}, threadCnt).solve();
+  return answers;
+}
+
+void print(const Answers &answers) {
+  std::cout << "// 由 gen_answers.cpp 生成，不要手改\n\n"
+            << "#pragma once\n\n"
+            << std::hexfloat << "constexpr unsigned long ANSWER_7 = "
+            << answers.answer7 << "UL;\n\n"
+            << "// 下标是 target，超过的都是 0\n"
+            << "constexpr double ANSWER_8[] = {\n";
+  for (double p : answers.answer8)
+    std::cout << "    " << p << ",\n";
+  std::cout << "};\n\n"
+            << "constexpr double ANSWER_9 = " << answers.answer9 << ";\n";
+}
+
+int check([[maybe_unused]] const Answers &answers) {
+#ifdef HAS_ANSWERS
+  static_assert(std::size(ANSWER_8) == ReachDistribution::MAX_TARGET + 1);
+  bool ok = answers.answer7 == ANSWER_7 && answers.answer9 == ANSWER_9;
+  for (unsigned t = 0; t <= ReachDistribution::MAX_TARGET; ++t)
+    ok = ok && answers.answer8[t] == ANSWER_8[t];
+  std::cout << (ok ? "answers.hpp is consistent\n"
+                   : "answers.hpp is stale, regenerate it\n");
+  return ok ? 0 : 1;
+#else
+  std::cerr << "compiled without answers.hpp\n";
+  return 1;
+#endif
+}
+
+int main(int argc, char **argv) {
+  const bool checkMode = argc > 1 && !std::strcmp(argv[1], "check");
+  const int threadArg = checkMode ? 2 : 1;
+  const unsigned threadCnt = argc > threadArg
+                                 ? std::atoi(argv[threadArg])
+                                 : std::thread::hardware_concurrency();
+  const Answers answers = solveAll(threadCnt);
+  if (checkMode)
+    return check(answers);
+  print(answers);
+  return 0;
+}
@@ -0,0 +1,167 @@
+// 求解器的计数器，用来看搜了多大的状态空间、时间花在哪
+// 编译时加 -DSOLVER_STATS 才有，默认全部编译掉，不影响速度
+//
+// - 展开的“先手放”“先手移”局面数（以前的 solve1 / solve2 调用）
+// - 记忆化的查找、命中、写入；不同的规范形局面数（第一次写进表或者枚举到的）
+// - 记忆化表同时占用内存的峰值：HashMemo 和逆推的各层数组
+// - 逆推每层（数字和的一半）枚举和填值各花的时间
+// 计数用 relaxed 的原子变量，多线程也能用；报告在 report() 里输出到标准错误
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace instrument {
+
+#ifdef SOLVER_STATS
+inline constexpr bool ENABLED = true;
+#else
+inline constexpr bool ENABLED = false;
+#endif
+
+enum Counter {
+  PLACE_CALLS,
+  MOVE_CALLS,
+  MEMO_LOOKUPS,
+  MEMO_HITS,
+  MEMO_INSERTS,
+  STATES,
+  COUNTER_CNT
+};
+
+inline constexpr const char *COUNTER_NAMES[COUNTER_CNT] = {
+    "place calls", "move calls",   "memo lookups",
+    "memo hits",   "memo inserts", "states"};
+
+enum Phase { ENUMERATE, SOLVE, PHASE_CNT };
+
+struct Totals {
+  std::atomic<std::uint64_t> counters[COUNTER_CNT]{};
+  std::atomic<std::int64_t> memoryBytes{0}, peakMemoryBytes{0};
+  std::mutex mutex;                            // 保护 layerSeconds
+  std::vector<double> layerSeconds[PHASE_CNT]; // 下标是数字和的一半
+};
+
+inline Totals totals;
+
+inline void count(Counter counter, std::uint64_t n = 1) {
+  if constexpr (ENABLED)
+    totals.counters[counter].fetch_add(n, std::memory_order_relaxed);
+}
+
+inline void addMemory(std::int64_t bytes) {
+  if constexpr (ENABLED) {
+    const std::int64_t now =
+        totals.memoryBytes.fetch_add(bytes, std::memory_order_relaxed) +
+        bytes;
+    std::int64_t peak = totals.peakMemoryBytes.load(std::memory_order_relaxed);
+    while (peak < now && !totals.peakMemoryBytes.compare_exchange_weak(
+                             peak, now, std::memory_order_relaxed))
+      ;
+  }
+}
+
+// 登记一块内存现在有多大，析构时注销；关掉时是空的
+template <bool ON> class BasicGauge {
+private:
+  std::size_t bytes = 0;
+
+public:
+  BasicGauge() = default;
+  BasicGauge(const BasicGauge &other) { set(other.bytes); }
+  BasicGauge(BasicGauge &&other) noexcept : bytes(other.bytes) {
+    other.bytes = 0;
+  }
+  BasicGauge &operator=(const BasicGauge &other) {
+    set(other.bytes);
+    return *this;
+  }
+  BasicGauge &operator=(BasicGauge &&other) noexcept {
+    if (this != &other) {
+      set(0);
+      bytes = other.bytes;
+      other.bytes = 0;
+    }
+    return *this;
+  }
+  ~BasicGauge() { set(0); }
+
+  void set(std::size_t newBytes) {
+    addMemory(std::int64_t(newBytes) - std::int64_t(bytes));
+    bytes = newBytes;
+  }
+};
+
+template <> class BasicGauge<false> {
+public:
+  void set(std::size_t) {}
+};
+
+using MemoryGauge = BasicGauge<ENABLED>;
+
+using Clock = std::chrono::steady_clock;
+
+// 关掉时不读时钟
+inline Clock::time_point now() {
+  if constexpr (ENABLED)
+    return Clock::now();
+  else
+    return {};
+}
+
+// 第 layer 层的 phase 从 start 开始到现在
+inline void recordLayer(Phase phase, std::size_t layer,
+                        Clock::time_point start) {
+  if constexpr (ENABLED) {
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+    const std::lock_guard<std::mutex> lock(totals.mutex);
+    std::vector<double> &seconds = totals.layerSeconds[phase];
+    if (seconds.size() <= layer)
+      seconds.resize(layer + 1);
+    seconds[layer] += elapsed.count();
+  }
+}
+
+// 关掉时什么都不输出
+inline void report(std::ostream &out = std::cerr) {
+  if constexpr (ENABLED) {
+    const std::lock_guard<std::mutex> lock(totals.mutex);
+    out << "solver stats:\n";
+    for (unsigned c = 0; c < COUNTER_CNT; ++c)
+      out << "  " << COUNTER_NAMES[c] << ": " << totals.counters[c] << '\n';
+    if (const std::uint64_t lookups = totals.counters[MEMO_LOOKUPS])
+      out << "  memo hit rate: " << std::fixed << std::setprecision(4)
+          << double(totals.counters[MEMO_HITS]) / lookups << '\n';
+    out << "  peak memo memory: " << std::fixed << std::setprecision(1)
+        << totals.peakMemoryBytes / double(1 << 20) << " MiB\n";
+    const std::vector<double> &enumerate = totals.layerSeconds[ENUMERATE];
+    const std::vector<double> &solve = totals.layerSeconds[SOLVE];
+    if (enumerate.empty() && solve.empty())
+      return;
+    out << "  seconds per layer (tile sum, enumerate, solve):\n"
+        << std::fixed << std::setprecision(6);
+    for (std::size_t s = 0; s < std::max(enumerate.size(), solve.size());
+         ++s) {
+      const double a = s < enumerate.size() ? enumerate[s] : 0;
+      const double b = s < solve.size() ? solve[s] : 0;
+      if (a || b)
+        out << "    " << 2 * s << ' ' << a << ' ' << b << '\n';
+    }
+    out << std::defaultfloat;
+  }
+}
+
+// 离开作用域时输出报告，放在 main 或者驱动函数的开头
+struct ReportOnExit {
+  ~ReportOnExit() { report(); }
+};
+
+} // namespace instrument
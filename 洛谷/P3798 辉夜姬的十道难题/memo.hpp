@@ -0,0 +1,168 @@
+// 记忆化用的开放寻址哈希表，键是压缩的局面（Shape::Key，64 或 128 位）
+// 线性探测，负载超过 1/2 时翻倍；只插入不删除
+// DenseMemo 是局面事先编好号时的多线程版本，只有值数组
+// 开了 SOLVER_STATS 时查找、写入和占用的内存记进 instrument.hpp 的计数器
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "instrument.hpp"
+
+// splitmix64 的收尾混合
+inline std::uint64_t mix64(std::uint64_t key) {
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111eb;
+  key ^= key >> 31;
+  return key;
+}
+
+// 128 位的键先把高半边混进低半边
+template <class Key> std::uint64_t hashKey(Key key) {
+  if constexpr (sizeof(Key) > sizeof(std::uint64_t))
+    return mix64(std::uint64_t(key) ^ mix64(std::uint64_t(key >> 64)));
+  else
+    return mix64(key);
+}
+
+template <class Value, class Key = std::uint64_t> class HashMemo {
+private:
+  // 每格 5 位，键总用不满，全 1 不会和合法局面冲突
+  static constexpr Key EMPTY = ~Key(0);
+
+  std::vector<Key> keys;
+  std::vector<Value> values;
+  std::size_t cnt = 0;
+  [[no_unique_address]] instrument::MemoryGauge gauge;
+
+  void measure() { gauge.set(keys.size() * (sizeof(Key) + sizeof(Value))); }
+
+  std::size_t slot(Key key) const {
+    const std::size_t mask = keys.size() - 1;
+    std::size_t i = hashKey(key) & mask;
+    while (keys[i] != EMPTY && keys[i] != key)
+      i = (i + 1) & mask;
+    return i;
+  }
+
+  void grow() {
+    std::vector<Key> oldKeys(keys.size() * 2, EMPTY);
+    std::vector<Value> oldValues(values.size() * 2);
+    oldKeys.swap(keys);
+    oldValues.swap(values);
+    for (std::size_t i = 0; i < oldKeys.size(); ++i) {
+      if (oldKeys[i] != EMPTY) {
+        const std::size_t j = slot(oldKeys[i]);
+        keys[j] = oldKeys[i];
+        values[j] = std::move(oldValues[i]);
+      }
+    }
+    measure();
+  }
+
+public:
+  // capacity 必须是 2 的幂
+  explicit HashMemo(std::size_t capacity = std::size_t(1) << 16)
+      : keys(capacity, EMPTY), values(capacity) {
+    measure();
+  }
+
+  // 找不到返回 nullptr
+  // 返回的指针在下一次 insert 之前有效，递归求值时不要跨调用持有
+  const Value *find(Key key) const {
+    const std::size_t i = slot(key);
+    instrument::count(instrument::MEMO_LOOKUPS);
+    if (keys[i] == EMPTY)
+      return nullptr;
+    instrument::count(instrument::MEMO_HITS);
+    return &values[i];
+  }
+
+  void insert(Key key, Value value) {
+    if ((cnt + 1) * 2 > keys.size())
+      grow();
+    const std::size_t i = slot(key);
+    instrument::count(instrument::MEMO_INSERTS);
+    if (keys[i] == EMPTY) {
+      keys[i] = key;
+      ++cnt;
+      instrument::count(instrument::STATES);
+    }
+    values[i] = std::move(value);
+  }
+
+  std::size_t size() const { return cnt; }
+  std::size_t capacity() const { return keys.size(); }
+};
+
+// 多线程共用、局面事先编好号的记忆化表（编号见 perfect.hpp）：
+// 值放在下标 [0, size) 的数组里，不存键，每项一个原子的状态字节
+// claim 到的线程负责算完再 publish，别的线程看到“正在算”就去做别的，
+// 不会有两个线程算同一个局面
+template <class Value> class DenseMemo {
+public:
+  enum class Claim { DONE, MINE, BUSY };
+
+private:
+  enum : std::uint8_t { EMPTY, BUSY, DONE };
+
+  std::vector<Value> values;
+  std::unique_ptr<std::atomic<std::uint8_t>[]> flags;
+  std::size_t cnt = 0;
+  [[no_unique_address]] instrument::MemoryGauge gauge;
+
+public:
+  // 清空并改成 size 项
+  void reset(std::size_t size) {
+    values.assign(size, Value{});
+    flags = std::make_unique<std::atomic<std::uint8_t>[]>(size);
+    cnt = size;
+    gauge.set(size * (sizeof(Value) + sizeof(flags[0])));
+  }
+
+  // 已经算好：DONE，value 是结果；没人算过：记上标记，返回 MINE；
+  // 别的线程正在算：BUSY
+  Claim claim(std::size_t i, Value &value) {
+    instrument::count(instrument::MEMO_LOOKUPS);
+    std::uint8_t flag = EMPTY;
+    if (flags[i].compare_exchange_strong(flag, BUSY,
+                                         std::memory_order_acquire))
+      return Claim::MINE;
+    if (flag == BUSY)
+      return Claim::BUSY;
+    instrument::count(instrument::MEMO_HITS);
+    value = values[i];
+    return Claim::DONE;
+  }
+
+  void publish(std::size_t i, Value value) {
+    instrument::count(instrument::MEMO_INSERTS);
+    values[i] = std::move(value);
+    flags[i].store(DONE, std::memory_order_release);
+  }
+
+  // 只读已经算好的结果
+  bool find(std::size_t i, Value &value) const {
+    instrument::count(instrument::MEMO_LOOKUPS);
+    if (flags[i].load(std::memory_order_acquire) != DONE)
+      return false;
+    instrument::count(instrument::MEMO_HITS);
+    value = values[i];
+    return true;
+  }
+
+  // 算好的项数
+  std::size_t size() const {
+    std::size_t done = 0;
+    for (std::size_t i = 0; i < cnt; ++i)
+      done += flags[i].load(std::memory_order_relaxed) == DONE;
+    return done;
+  }
+};
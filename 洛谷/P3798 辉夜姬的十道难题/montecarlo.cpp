@@ -0,0 +1,104 @@
+// 8、9 的蒙特卡洛估计（见 montecarlo.hpp）
+// 用法：./montecarlo NxM 8 target POLICY games [threads] [seed]
+//       ./montecarlo NxM 9 POLICY games [threads] [seed]
+// NxM、target 和 variants 一样，seed 是非负整数；POLICY 是下面之一
+//   greedy          这一步合并得分最多的方向
+//   expectimax[:D]  限深 D 的期望最大搜索，默认 D = 2
+//   exact:FILE      7/8/9 用 --policy 存下的最优方向表，target 要一致
+// 标准输出是 “均值 标准误差”，8 是合出 2^target 的概率，9 是总得分
+// 标准错误输出局数和用时
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "cli.hpp"
+#include "montecarlo.hpp"
+#include "rules.hpp"
+
+template <class Rules, class MakePolicy>
+void report(const Rules &rules, const std::string &policy,
+            MakePolicy makePolicy, std::uint64_t games, unsigned threadCnt,
+            std::uint64_t seed) {
+  const auto start = std::chrono::steady_clock::now();
+  const Estimate estimate = simulate(rules, makePolicy, games, threadCnt, seed);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << std::fixed << std::setprecision(10) << estimate.mean << ' '
+            << estimate.standardError << '\n';
+  std::cerr << rules.describe() << ", " << policy << ": " << games
+            << " games in " << std::setprecision(2) << elapsed.count()
+            << " s\n";
+}
+
+template <class Rules>
+int run(const Rules &rules, const std::string &policy, std::uint64_t games,
+        unsigned threadCnt, std::uint64_t seed) {
+  using Shape = typename Rules::Shape;
+  if (policy == "greedy") {
+    report(rules, policy, [] { return GreedyPolicy<Shape>(); }, games,
+           threadCnt, seed);
+  } else if (policy == "expectimax" || policy.rfind("expectimax:", 0) == 0) {
+    unsigned depth = 2;
+    if (policy.size() > 10 && !parsePositive(policy.c_str() + 11, depth))
+      return -1;
+    report(rules, policy, [depth] { return ExpectimaxPolicy<Shape>(depth); },
+           games, threadCnt, seed);
+  } else if (policy.rfind("exact:", 0) == 0) {
+    const std::string path = policy.substr(6);
+    const MappedTable<BestMovePolicy<Rules>> table(path.c_str(), {rules});
+    if (!table.isOpen()) {
+      std::cerr << "cannot load " << path << " as BestMove "
+                << rules.describe() << '\n';
+      return 1;
+    }
+    report(rules, policy, [&table] { return ExactPolicy<Rules>(table); },
+           games, threadCnt, seed);
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+template <class S> int runShape(int argc, char **argv) {
+  const char *problem = argv[2];
+  int next = 3;
+  unsigned target = 0;
+  if (!std::strcmp(problem, "8") &&
+      (argc <= next || !parseTarget<S>(argv[next++], target)))
+    return -1;
+  if (argc < next + 2)
+    return -1;
+  const std::string policy = argv[next];
+  std::uint64_t games, seed = 20220323;
+  unsigned threadCnt = std::thread::hardware_concurrency();
+  if (!parsePositive(argv[next + 1], games) ||
+      (argc > next + 2 && !parsePositive(argv[next + 2], threadCnt)) ||
+      (argc > next + 3 && !parseUnsigned(argv[next + 3], seed)))
+    return -1;
+  if (!std::strcmp(problem, "8"))
+    return run(BasicReachProbability<S>{target}, policy, games, threadCnt,
+               seed);
+  if (!std::strcmp(problem, "9"))
+    return run(BasicExpectedScore<S>{}, policy, games, threadCnt, seed);
+  return -1;
+}
+
+int main(int argc, char **argv) {
+  int result = -1;
+  if (argc >= 3)
+    result = dispatchShape(argv[1], [&](auto shape) {
+      return runShape<typename decltype(shape)::type>(argc, argv);
+    });
+  if (result < 0) {
+    std::cerr << "usage: " << argv[0]
+              << " NxM 8 target|9 greedy|expectimax[:D]|exact:FILE games "
+                 "[threads] [seed]\n";
+    return 1;
+  }
+  return result;
+}
@@ -0,0 +1,208 @@
+// 8、9 的蒙特卡洛估计：穷举算不动的棋盘或者 target，用随机对局估计答案
+// 按题目的方式随机放（空格等概率，2 和 4 是 0.9 和 0.1），方向由策略决定，
+// 移动用的是 Shape::move，和精确求解器同一套
+//
+// 每局的值和 Rules 的定义一致：到达终止局面取 terminalValue()，
+// 再加上一路上 afterMove 计入的得分（8 不计分，9 计合并得分）
+// 策略只是下界：最优策略的期望至少是估计出的均值（减去误差）
+//
+// 策略需要提供 std::uint8_t choose(Key state)，返回 MOVES 里的方向，
+// 动不了时返回 NO_MOVE；每个线程各自构造一个
+// 还要提供 void reset()，每局开始时调用：策略里的缓存（比如置换表）不能跨局，
+// 否则一局的结果取决于同一个线程之前下过哪几局
+// - GreedyPolicy：这一步合并得分最多的方向
+// - ExactPolicy：查 --policy 存下的最优方向表（见 query.hpp）
+// - ExpectimaxPolicy：限深的期望最大搜索（见 expectimax.hpp）
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "expectimax.hpp"
+#include "memo.hpp"
+#include "query.hpp"
+#include "shape.hpp"
+#include "table.hpp"
+
+// 计数器式的随机数：第 stream 条流的第 i 个数只取决于 (seed, stream, i)，
+// 每局一条流，结果和线程数、调度顺序无关
+class CounterRng {
+private:
+  static constexpr std::uint64_t GAMMA = 0x9e3779b97f4a7c15;
+
+  std::uint64_t key, counter = 0;
+
+public:
+  CounterRng(std::uint64_t seed, std::uint64_t stream)
+      : key(mix64(seed ^ mix64(stream * GAMMA + GAMMA))) {}
+
+  std::uint64_t operator()() { return mix64(key + ++counter * GAMMA); }
+
+  // [0, n) 里均匀的整数，用高 32 位乘 n 再取高位
+  unsigned below(unsigned n) {
+    return static_cast<unsigned>(((*this)() >> 32) * n >> 32);
+  }
+
+  // [0, 1) 里均匀的实数
+  double uniform() { return ((*this)() >> 11) * 0x1p-53; }
+};
+
+// 随机挑一个空格放 2（0.9）或 4（0.1）；没有空格时原样返回
+template <class S>
+typename S::Key placeRandomly(typename S::Key state, CounterRng &rng) {
+  unsigned empty[S::CELLS], cnt = 0;
+  for (unsigned i = 0; i < S::CELLS; ++i) {
+    if (!S::getCell(state, i))
+      empty[cnt++] = i;
+  }
+  if (!cnt)
+    return state;
+  const unsigned pos = empty[rng.below(cnt)];
+  return S::place(state, pos, rng.uniform() < 0.9 ? 1 : 2);
+}
+
+template <class S> struct GreedyPolicy {
+  void reset() {}
+
+  std::uint8_t choose(typename S::Key state) const {
+    std::uint8_t best = NO_MOVE;
+    unsigned bestScore = 0;
+    for (std::uint8_t d = 0; d < 4; ++d) {
+      const typename S::Move p = S::move(d, state);
+      if (p.board != state && (best == NO_MOVE || bestScore < p.score)) {
+        best = d;
+        bestScore = p.score;
+      }
+    }
+    return best;
+  }
+};
+
+// 表里存的是规范形上的方向；对称的局面上挑一个
+// 走完之后和规范形上走完的规范形相同的方向，两者的值一样
+template <class Rules> class ExactPolicy {
+public:
+  using Shape = typename Rules::Shape;
+  using Key = typename Rules::Key;
+
+private:
+  const MappedTable<BestMovePolicy<Rules>> &table;
+
+public:
+  explicit ExactPolicy(const MappedTable<BestMovePolicy<Rules>> &table)
+      : table(table) {}
+
+  void reset() {}
+
+  // 表里没有的局面（不该出现）退回贪心
+  std::uint8_t choose(Key state) const {
+    const Key unique = Shape::getUniqueState(state);
+    std::uint8_t move;
+    if (!table.findMove(unique, move))
+      return GreedyPolicy<Shape>().choose(state);
+    if (move == NO_MOVE)
+      return NO_MOVE;
+    const Key target = Shape::getUniqueState(Shape::move(move, unique).board);
+    for (std::uint8_t d = 0; d < 4; ++d) {
+      const Key next = Shape::move(d, state).board;
+      if (next != state && Shape::getUniqueState(next) == target)
+        return d;
+    }
+    return GreedyPolicy<Shape>().choose(state);
+  }
+};
+
+// 估值按 9 的得分设计，用在 8 上只是个启发式
+template <class S> class ExpectimaxPolicy {
+private:
+  Expectimax<S> search;
+  typename Expectimax<S>::Limits limits;
+
+public:
+  // 只按深度截断，不看时间，结果可以复现
+  explicit ExpectimaxPolicy(unsigned depth, unsigned tableBits = 18)
+      : search(tableBits) {
+    limits.depth = depth;
+    limits.budget = std::chrono::hours(24);
+  }
+
+  void reset() { search.forget(); }
+
+  std::uint8_t choose(typename S::Key state) {
+    return search.search(state, limits).move;
+  }
+};
+
+struct Estimate {
+  double mean, standardError;
+  std::uint64_t games;
+};
+
+// 一局：先连放两块，之后移一步放一块，直到终止或者动不了
+template <class Rules, class Policy>
+double playout(const Rules &rules, Policy &policy, CounterRng &rng) {
+  using Shape = typename Rules::Shape;
+  using Key = typename Rules::Key;
+  const auto nothing = [](Key) { return typename Rules::Value{}; };
+  policy.reset();
+  Key state = placeRandomly<Shape>(placeRandomly<Shape>(Key(0), rng), rng);
+  double value = 0;
+  while (!rules.isTerminal(state)) {
+    const std::uint8_t d = policy.choose(state);
+    if (d == NO_MOVE)
+      return value;
+    const typename Shape::Move p = Shape::move(d, state);
+    value += rules.afterMove(p, nothing);
+    if (rules.isTerminal(p.board))
+      break;
+    state = placeRandomly<Shape>(p.board, rng);
+  }
+  return value + rules.terminalValue();
+}
+
+// games 局均分给各线程，makePolicy() 给每个线程造一个策略
+// 第 i 局用第 i 条随机数流，换线程数只改变求和的顺序
+// 一局可能很慢（比如用 expectimax），局数再少也按线程数分
+template <class Rules, class MakePolicy>
+Estimate simulate(const Rules &rules, MakePolicy makePolicy,
+                  std::uint64_t games, unsigned threadCnt,
+                  std::uint64_t seed) {
+  threadCnt = std::max(1U, threadCnt);
+  std::vector<double> sums(threadCnt), squares(threadCnt);
+  const auto run = [&](unsigned t) {
+    auto policy = makePolicy();
+    for (std::uint64_t i = games * t / threadCnt;
+         i < games * (t + 1) / threadCnt; ++i) {
+      CounterRng rng(seed, i);
+      const double value = playout(rules, policy, rng);
+      sums[t] += value;
+      squares[t] += value * value;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < threadCnt; ++t)
+    threads.emplace_back(run, t);
+  run(0);
+  for (std::thread &thread : threads)
+    thread.join();
+  double sum = 0, square = 0;
+  for (unsigned t = 0; t < threadCnt; ++t) {
+    sum += sums[t];
+    square += squares[t];
+  }
+  Estimate estimate{0, 0, games};
+  if (!games)
+    return estimate;
+  estimate.mean = sum / games;
+  if (games > 1) {
+    const double variance =
+        std::max(0.0, (square - sum * estimate.mean) / (games - 1));
+    estimate.standardError = std::sqrt(variance / games);
+  }
+  return estimate;
+}
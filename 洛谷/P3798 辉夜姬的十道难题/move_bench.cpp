@@ -0,0 +1,179 @@
+// 移动的微基准：查表版（board.hpp）对比原来逐行循环的写法
+// 用法：./move_bench [boards] [rounds]
+// 先逐个局面核对两种写法结果一致，再分别计时
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "board.hpp"
+
+namespace legacy {
+
+// 原来 7.cpp 的写法，四个方向各一份
+std::pair<unsigned long, State> moveUpwards(State state) {
+  unsigned long s = 0;
+  for (unsigned short i = 0; i < 3; ++i) {
+    bool flag = false;
+    std::vector<unsigned long> v;
+    for (unsigned short j = 0; j < 3; ++j) {
+      if (state.data[j][i]) {
+        if (flag && state.data[j][i] == v.back()) {
+          ++v.back();
+          s += 1UL << v.back();
+          flag = false;
+        } else {
+          v.push_back(state.data[j][i]);
+          flag = true;
+        }
+        state.data[j][i] = 0;
+      }
+    }
+    for (unsigned short j = 0; j < v.size(); ++j)
+      state.data[j][i] = v[j];
+  }
+  return {s, std::move(state)};
+}
+
+std::pair<unsigned long, State> moveDownwards(State state) {
+  unsigned long s = 0;
+  for (unsigned short i = 0; i < 3; ++i) {
+    bool flag = false;
+    std::vector<unsigned long> v;
+    for (unsigned short j = 3; j--;) {
+      if (state.data[j][i]) {
+        if (flag && state.data[j][i] == v.back()) {
+          ++v.back();
+          s += 1UL << v.back();
+          flag = false;
+        } else {
+          v.push_back(state.data[j][i]);
+          flag = true;
+        }
+        state.data[j][i] = 0;
+      }
+    }
+    for (unsigned short j = 2, k = 0; k < v.size(); --j, ++k)
+      state.data[j][i] = v[k];
+  }
+  return {s, std::move(state)};
+}
+
+std::pair<unsigned long, State> moveLeft(State state) {
+  unsigned long s = 0;
+  for (unsigned short i = 0; i < 3; ++i) {
+    bool flag = false;
+    std::vector<unsigned long> v;
+    for (unsigned short j = 0; j < 3; ++j) {
+      if (state.data[i][j]) {
+        if (flag && state.data[i][j] == v.back()) {
+          ++v.back();
+          s += 1UL << v.back();
+          flag = false;
+        } else {
+          v.push_back(state.data[i][j]);
+          flag = true;
+        }
+        state.data[i][j] = 0;
+      }
+    }
+    for (unsigned short j = 0; j < v.size(); ++j)
+      state.data[i][j] = v[j];
+  }
+  return {s, std::move(state)};
+}
+
+std::pair<unsigned long, State> moveRight(State state) {
+  unsigned long s = 0;
+  for (unsigned short i = 0; i < 3; ++i) {
+    bool flag = false;
+    std::vector<unsigned long> v;
+    for (unsigned short j = 3; j--;) {
+      if (state.data[i][j]) {
+        if (flag && state.data[i][j] == v.back()) {
+          ++v.back();
+          s += 1UL << v.back();
+          flag = false;
+        } else {
+          v.push_back(state.data[i][j]);
+          flag = true;
+        }
+        state.data[i][j] = 0;
+      }
+    }
+    for (unsigned short j = 2, k = 0; k < v.size(); --j, ++k)
+      state.data[i][j] = v[k];
+  }
+  return {s, std::move(state)};
+}
+
+std::pair<unsigned long, State> (*const MOVES[4])(State) = {
+    moveUpwards, moveDownwards, moveLeft, moveRight};
+
+} // namespace legacy
+
+// 计时 f 跑 rounds 轮，返回每次移动的纳秒数
+template <class F> double measure(std::size_t moveCnt, int rounds, F f) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; ++i)
+    f();
+  const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (double(moveCnt) * rounds);
+}
+
+int main(int argc, char **argv) {
+  const int boardCnt = argc > 1 ? std::atoi(argv[1]) : 1 << 16;
+  const int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+
+  // 随机局面：约三分之一是空格，其余指数 1..11
+  std::mt19937_64 rng(20220323);
+  std::vector<Board> boards(boardCnt);
+  std::vector<State> states(boardCnt);
+  for (int i = 0; i < boardCnt; ++i) {
+    for (unsigned short r = 0; r < 3; ++r) {
+      for (unsigned short c = 0; c < 3; ++c)
+        states[i].data[r][c] = rng() % 3 ? rng() % 11 + 1 : 0;
+    }
+    boards[i] = pack(states[i]);
+  }
+
+  for (int i = 0; i < boardCnt; ++i) {
+    for (int d = 0; d < 4; ++d) {
+      const auto [score, state] = legacy::MOVES[d](states[i]);
+      const Move move = MOVES[d](boards[i]);
+      if (move.board != pack(state) || move.score != score) {
+        std::fprintf(stderr, "mismatch: board %d, direction %d\n", i, d);
+        return 1;
+      }
+    }
+  }
+
+  const std::size_t moveCnt = std::size_t(boardCnt) * 4;
+  std::uint64_t checksum = 0;
+  const double legacyNs = measure(moveCnt, rounds, [&] {
+    for (const State &state : states) {
+      for (auto move : legacy::MOVES) {
+        const auto p = move(state);
+        checksum += p.first + p.second.data[1][1];
+      }
+    }
+  });
+  const double tableNs = measure(moveCnt, rounds, [&] {
+    for (Board board : boards) {
+      for (auto move : MOVES) {
+        const Move p = move(board);
+        checksum += p.score + p.board;
+      }
+    }
+  });
+  std::printf("{\"boards\":%d,\"rounds\":%d,\"legacyNsPerMove\":%.2f,"
+              "\"tableNsPerMove\":%.2f,\"speedup\":%.2f,\"checksum\":%llu}\n",
+              boardCnt, rounds, legacyNs, tableNs, legacyNs / tableNs,
+              static_cast<unsigned long long>(checksum));
+  return 0;
+}
@@ -0,0 +1,149 @@
+// 多线程的自顶向下求解，和 RetrogradeSolver 用同一套 Rules
+//
+// 先用 enumerateLayers 枚举出全部可达的规范形，建好完美哈希（perfect.hpp），
+// 记忆化表就是按编号排的值数组（DenseMemo），不用边算边插入
+// 每个线程都从空局面出发做记忆化搜索，共用两张 DenseMemo
+// 一个局面先 claim 到的线程负责算它；孩子被别人占着时先跳过，
+// 做完其余的孩子再回来等，各线程从不同的孩子开始，自然分散到不同的子树
+// 放一块数字和变大，移动不变但会从“先手移”变成“先手放”，所以图无环，
+// 等待链只会往下走，不会死锁
+//
+// 孩子的值都齐了之后再按原来的顺序调用 rules.place / rules.move 合并，
+// 结果和单线程逐位相同
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "instrument.hpp"
+#include "memo.hpp"
+#include "perfect.hpp"
+#include "shape.hpp"
+
+template <class Rules> class ParallelSolver {
+public:
+  using Shape = typename Rules::Shape;
+  using Key = typename Rules::Key;
+  using Value = typename Rules::Value;
+
+private:
+  // 放的孩子最多是格数的两倍，移的孩子最多 4 个
+  static constexpr std::size_t MAX_CHILDREN = 2 * Shape::CELLS;
+
+  Rules rules;
+  unsigned threadCnt;
+  ReachableStates<Rules> states;
+  DenseMemo<Value> placeMemo, moveMemo; // 先手放 / 先手移
+
+  template <bool PLACE> DenseMemo<Value> &memoOf() {
+    return PLACE ? placeMemo : moveMemo;
+  }
+
+  // state 是可达的规范形
+  template <bool PLACE> std::size_t indexOf(Key state) const {
+    return PLACE ? states.findPlace(state) : states.findMove(state);
+  }
+
+  // 已经算好的值；state 必须已经算好
+  template <bool PLACE> Value get(Key state) {
+    if (rules.isTerminal(state))
+      return rules.terminalValue();
+    Value value{};
+    memoOf<PLACE>().find(indexOf<PLACE>(Shape::getUniqueState(state)),
+                         value);
+    return value;
+  }
+
+  // 用 Rules 自己枚举孩子，值先随便给
+  template <bool PLACE>
+  std::size_t getChildren(Key state, Key children[]) const {
+    std::size_t cnt = 0;
+    const auto collect = [&](Key next) {
+      children[cnt++] = next;
+      return Value{};
+    };
+    if constexpr (PLACE)
+      rules.place(state, collect);
+    else
+      rules.move(state, collect);
+    return cnt;
+  }
+
+  // 保证 state 算好；别人正在算时，wait 为 false 就直接返回 false
+  template <bool PLACE> bool ensure(Key state, unsigned t, bool wait) {
+    if (rules.isTerminal(state))
+      return true;
+    state = Shape::getUniqueState(state);
+    const std::size_t i = indexOf<PLACE>(state);
+    Value value;
+    for (;;) {
+      switch (memoOf<PLACE>().claim(i, value)) {
+      case DenseMemo<Value>::Claim::DONE:
+        return true;
+      case DenseMemo<Value>::Claim::MINE:
+        compute<PLACE>(state, i, t);
+        return true;
+      case DenseMemo<Value>::Claim::BUSY:
+        if (!wait)
+          return false;
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // 先把孩子都算好，跳过别人占着的，从第 t 个开始转一圈
+  template <bool CHILD_PLACE>
+  void ensureChildren(const Key children[], std::size_t cnt, unsigned t) {
+    Key busy[MAX_CHILDREN];
+    std::size_t busyCnt = 0;
+    for (std::size_t k = 0; k < cnt; ++k) {
+      const Key child = children[(k + t) % cnt];
+      if (!ensure<CHILD_PLACE>(child, t, false))
+        busy[busyCnt++] = child;
+    }
+    for (std::size_t k = 0; k < busyCnt; ++k)
+      ensure<CHILD_PLACE>(busy[k], t, true);
+  }
+
+  template <bool PLACE> void compute(Key state, std::size_t i, unsigned t) {
+    instrument::count(PLACE ? instrument::PLACE_CALLS : instrument::MOVE_CALLS);
+    Key children[MAX_CHILDREN];
+    const std::size_t cnt = getChildren<PLACE>(state, children);
+    ensureChildren<!PLACE>(children, cnt, t);
+    const auto next = [this](Key child) { return get<!PLACE>(child); };
+    if constexpr (PLACE)
+      memoOf<PLACE>().publish(i, rules.place(state, next));
+    else
+      memoOf<PLACE>().publish(i, rules.move(state, next));
+  }
+
+public:
+  explicit ParallelSolver(Rules rules = {},
+                          unsigned threadCnt = std::max(
+                              1U, std::thread::hardware_concurrency()))
+      : rules(rules), threadCnt(std::max(1U, threadCnt)) {}
+
+  // 空局面上先连放两块，所以根的孩子是“先手放”的局面
+  Value solve() {
+    states.enumerate(rules, threadCnt);
+    placeMemo.reset(states.getPlaceCnt());
+    moveMemo.reset(states.getMoveCnt());
+    Key children[MAX_CHILDREN];
+    const std::size_t cnt = getChildren<true>(Key(0), children);
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCnt; ++t)
+      threads.emplace_back([&, t] { ensureChildren<true>(children, cnt, t); });
+    ensureChildren<true>(children, cnt, 0);
+    for (std::thread &thread : threads)
+      thread.join();
+    return rules.place(Key(0), [this](Key next) { return get<true>(next); });
+  }
+
+  // 算过的局面数（先手放 + 先手移）
+  std::size_t getStateCnt() const {
+    return placeMemo.size() + moveMemo.size();
+  }
+};
@@ -0,0 +1,198 @@
+// 可达局面的最小完美哈希：局面集合事先就能枚举出来（enumerateLayers），
+// 不需要边算边插入的哈希表，给每个规范形一个 [0, n) 里的编号就够了，
+// 值放进按编号排的数组（见 memo.hpp 的 DenseMemo），不存键
+//
+// PerfectHash 是 PTHash 的做法：键按哈希分进 n / BUCKET_SIZE 个桶，
+// 每个桶挑一个 pilot，桶里的键落在表长为 n / ALPHA 的表的
+// fastrange(mix64(h ^ mix64(pilot)), tableSize) 上；
+// 构造时从大桶到小桶，pilot 从 0 往上试，直到桶里的键都落在空位上
+// 落在 [n, tableSize) 的少数键再用 remap 挪到 [0, n) 里剩下的空位
+// 查询是几次哈希、一次读 pilots，没有探测，也没有循环；
+// 只有约 5% 的键多读一次 remap，这个分支几乎总是走同一边
+// 不在集合里的键也会得到一个编号，调用者要保证键是可达的规范形
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "instrument.hpp"
+#include "memo.hpp"
+#include "retrograde.hpp"
+
+template <class Key> class PerfectHash {
+private:
+  // 桶越大、表越满，pilots 越小但构造越慢；
+  // 8 9 的 2311 万个局面用这组参数约 3 秒，每个键 12 位出头
+  static constexpr unsigned BUCKET_SIZE = 3;
+  static constexpr double ALPHA = 0.95; // 键数 / 表长
+
+  std::uint64_t n = 0, tableSize = 0, seed = 0;
+  std::vector<std::uint32_t> pilots{0};
+  std::vector<std::uint32_t> remap;
+
+  static std::uint64_t fastrange(std::uint64_t h, std::uint64_t n) {
+    return static_cast<std::uint64_t>((unsigned __int128)h * n >> 64);
+  }
+
+  // 64 位的键互不相同时哈希也互不相同（每一步都是双射）
+  std::uint64_t hash(Key key) const { return mix64(hashKey(key) ^ seed); }
+
+  std::uint64_t position(std::uint64_t h, std::uint32_t pilot) const {
+    return fastrange(mix64(h ^ mix64(pilot)), tableSize);
+  }
+
+  // 同一个桶里有两个键哈希相同（只有 128 位的键可能）时失败
+  bool tryBuild(const std::vector<Key> &keys) {
+    const std::size_t m = pilots.size();
+    std::vector<std::uint64_t> hashes(n);
+    std::vector<std::size_t> start(m + 1);
+    for (std::size_t i = 0; i < n; ++i)
+      ++start[fastrange(hash(keys[i]), m) + 1];
+    for (std::size_t b = 0; b < m; ++b)
+      start[b + 1] += start[b];
+    {
+      std::vector<std::size_t> next(start.begin(), start.end() - 1);
+      for (std::size_t i = 0; i < n; ++i) {
+        const std::uint64_t h = hash(keys[i]);
+        hashes[next[fastrange(h, m)]++] = h;
+      }
+    }
+    // 大桶先放，空位多的时候好找
+    std::vector<std::size_t> order(m);
+    for (std::size_t b = 0; b < m; ++b)
+      order[b] = b;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) {
+                       return start[a + 1] - start[a] >
+                              start[b + 1] - start[b];
+                     });
+    std::vector<std::uint64_t> taken((tableSize + 63) / 64);
+    std::vector<std::uint64_t> slots;
+    for (const std::size_t b : order) {
+      const std::uint64_t *h = hashes.data() + start[b];
+      const std::size_t size = start[b + 1] - start[b];
+      if (!size)
+        break;
+      std::sort(hashes.begin() + start[b], hashes.begin() + start[b + 1]);
+      if (std::adjacent_find(h, h + size) != h + size)
+        return false;
+      for (std::uint32_t pilot = 0;; ++pilot) {
+        slots.clear();
+        for (std::size_t k = 0; k < size; ++k) {
+          const std::uint64_t p = position(h[k], pilot);
+          if (taken[p / 64] >> (p % 64) & 1 ||
+              std::find(slots.begin(), slots.end(), p) != slots.end())
+            break;
+          slots.push_back(p);
+        }
+        if (slots.size() == size) {
+          for (const std::uint64_t p : slots)
+            taken[p / 64] |= std::uint64_t(1) << (p % 64);
+          pilots[b] = pilot;
+          break;
+        }
+        if (pilot == UINT32_MAX)
+          return false;
+      }
+    }
+    remap.assign(tableSize - n, 0);
+    std::uint64_t free = 0;
+    for (std::uint64_t p = n; p < tableSize; ++p) {
+      if (!(taken[p / 64] >> (p % 64) & 1))
+        continue;
+      while (taken[free / 64] >> (free % 64) & 1)
+        ++free;
+      remap[p - n] = free++;
+    }
+    return true;
+  }
+
+public:
+  PerfectHash() = default;
+
+  // keys 互不相同
+  explicit PerfectHash(const std::vector<Key> &keys) : n(keys.size()) {
+    if (!n)
+      return;
+    tableSize = std::max<std::uint64_t>(n, n / ALPHA);
+    pilots.assign((n + BUCKET_SIZE - 1) / BUCKET_SIZE, 0);
+    while (!tryBuild(keys)) {
+      ++seed;
+      std::fill(pilots.begin(), pilots.end(), 0);
+    }
+  }
+
+  std::size_t operator()(Key key) const {
+    const std::uint64_t h = hash(key);
+    const std::uint64_t p = position(h, pilots[fastrange(h, pilots.size())]);
+    return p < n ? p : remap[p - n];
+  }
+
+  std::size_t size() const { return n; }
+  std::size_t getBytes() const {
+    return (pilots.size() + remap.size()) * sizeof(std::uint32_t);
+  }
+};
+
+// 从空局面可达的全部规范形，分层各建一个 PerfectHash，编号各层连续排下去
+// “先手放”和“先手移”分开编号；只留哈希，不留键
+template <class Rules> class ReachableStates {
+public:
+  using Shape = typename Rules::Shape;
+  using Key = typename Rules::Key;
+
+private:
+  struct Layer {
+    PerfectHash<Key> place, move;
+    std::size_t placeOffset = 0, moveOffset = 0;
+  };
+
+  std::vector<Layer> layers; // 下标是数字和的一半
+  std::size_t placeCnt = 0, moveCnt = 0;
+  [[no_unique_address]] instrument::MemoryGauge gauge;
+
+public:
+  void enumerate(const Rules &rules, unsigned threadCnt) {
+    layers.clear();
+    placeCnt = moveCnt = 0;
+    enumerateLayers(rules, threadCnt,
+                    [this](std::size_t s, std::vector<Key> &toPlace,
+                           std::vector<Key> &toMove) {
+                      if (layers.size() <= s)
+                        layers.resize(s + 1);
+                      Layer &layer = layers[s];
+                      layer.place = PerfectHash<Key>(toPlace);
+                      layer.move = PerfectHash<Key>(toMove);
+                      layer.placeOffset = placeCnt;
+                      layer.moveOffset = moveCnt;
+                      placeCnt += toPlace.size();
+                      moveCnt += toMove.size();
+                    });
+    gauge.set(getBytes());
+    instrument::count(instrument::STATES, placeCnt + moveCnt);
+  }
+
+  // state 必须是可达的规范形
+  std::size_t findPlace(Key state) const {
+    const Layer &layer = layers[Shape::getLayer(state)];
+    return layer.placeOffset + layer.place(state);
+  }
+
+  std::size_t findMove(Key state) const {
+    const Layer &layer = layers[Shape::getLayer(state)];
+    return layer.moveOffset + layer.move(state);
+  }
+
+  std::size_t getPlaceCnt() const { return placeCnt; }
+  std::size_t getMoveCnt() const { return moveCnt; }
+
+  std::size_t getBytes() const {
+    std::size_t bytes = layers.size() * sizeof(Layer);
+    for (const Layer &layer : layers)
+      bytes += layer.place.getBytes() + layer.move.getBytes();
+    return bytes;
+  }
+};
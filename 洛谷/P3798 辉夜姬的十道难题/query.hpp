@@ -0,0 +1,167 @@
+// 任意局面的查询：轮到移动的一方面对 board，它的值和最好的方向
+// 先查 mmap 进来的表（可选），表里没有的局面（比如从空局面走不到的）
+// 自顶向下递归求值，结果留在 HashMemo 里，后面的查询接着用
+//
+// 只支持值是标量的 Rules，另外需要：
+//   template <class F> Value afterMove(const Shape::Move &p, F next) const;
+//     走了 p 之后的值，next(p.board) 是“先手放”的值
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "instrument.hpp"
+#include "memo.hpp"
+#include "shape.hpp"
+#include "table.hpp"
+
+// 和 MOVES 的顺序一致；NO_MOVE 表示哪个方向都动不了（或者已经终止）
+constexpr const char *MOVE_NAMES[5] = {"up", "down", "left", "right", "none"};
+constexpr std::uint8_t NO_MOVE = 4;
+
+// 先手移的局面上最好的方向，一样好时取 MOVES 里靠前的
+// value 得到和 rules.move(state, nextPlace) 一样的值
+template <class Rules, class F>
+std::uint8_t getBestMove(const Rules &rules, typename Rules::Key state,
+                         F nextPlace, typename Rules::Value &value) {
+  std::uint8_t best = NO_MOVE;
+  value = 0;
+  for (std::uint8_t d = 0; d < 4; ++d) {
+    const typename Rules::Shape::Move p = Rules::Shape::move(d, state);
+    if (p.board == state)
+      continue;
+    const typename Rules::Value v = rules.afterMove(p, nextPlace);
+    if (best == NO_MOVE || value < v) {
+      best = d;
+      value = v;
+    }
+  }
+  return best;
+}
+
+template <class Rules> class PositionQuery {
+public:
+  using Shape = typename Rules::Shape;
+  using Key = typename Rules::Key;
+  using Value = typename Rules::Value;
+
+  struct Answer {
+    Value value;
+    std::uint8_t move;
+  };
+
+private:
+  Rules rules;
+  const MappedTable<Rules> *table;
+  HashMemo<Value, Key> placeMemo, moveMemo;
+
+  Value placeValue(Key state) {
+    if (rules.isTerminal(state))
+      return rules.terminalValue();
+    Value value;
+    if (table && table->findPlace(state, value))
+      return value;
+    state = Shape::getUniqueState(state);
+    if (const Value *p = placeMemo.find(state))
+      return *p;
+    instrument::count(instrument::PLACE_CALLS);
+    value = rules.place(state, [this](Key next) { return moveValue(next); });
+    placeMemo.insert(state, value);
+    return value;
+  }
+
+  Value moveValue(Key state) {
+    if (rules.isTerminal(state))
+      return rules.terminalValue();
+    Value value;
+    if (table && table->findMove(state, value))
+      return value;
+    state = Shape::getUniqueState(state);
+    if (const Value *p = moveMemo.find(state))
+      return *p;
+    instrument::count(instrument::MOVE_CALLS);
+    value = rules.move(state, [this](Key next) { return placeValue(next); });
+    moveMemo.insert(state, value);
+    return value;
+  }
+
+public:
+  // table 可以为空，这时所有局面都现算
+  explicit PositionQuery(const Rules &rules = {},
+                         const MappedTable<Rules> *table = nullptr)
+      : rules(rules), table(table) {}
+
+  // 方向是相对传进来的 state 说的，不是规范形
+  Answer query(Key state) {
+    Answer answer{rules.terminalValue(), NO_MOVE};
+    if (rules.isTerminal(state))
+      return answer;
+    answer.move = getBestMove(
+        rules, state, [this](Key next) { return placeValue(next); },
+        answer.value);
+    return answer;
+  }
+
+  // 表里查不到、现算出来的局面数
+  std::size_t getMemoSize() const {
+    return placeMemo.size() + moveMemo.size();
+  }
+};
+
+// 最优方向表的“Rules”：和 table.hpp 同样的格式，值换成一个字节的方向
+// 只存先手移的局面，终止局面不在表里，查到的是 NO_MOVE
+template <class Rules> struct BestMovePolicy {
+  using Shape = typename Rules::Shape;
+  using Key = typename Rules::Key;
+  using Value = std::uint8_t;
+
+  Rules rules;
+
+  std::string describe() const { return "BestMove " + rules.describe(); }
+  bool isTerminal(Key state) const { return rules.isTerminal(state); }
+  Value terminalValue() const { return NO_MOVE; }
+};
+
+// 作为 RetrogradeSolver::solve 的回调，每填好一层就写出这一层的最优方向
+// 移动不改变数字和，先手移的孩子都在同一层的先手放里
+template <class Rules> class PolicyWriter {
+public:
+  using Shape = typename Rules::Shape;
+  using Key = typename Rules::Key;
+  using Value = typename Rules::Value;
+
+private:
+  Rules rules;
+  TableWriter<BestMovePolicy<Rules>> writer;
+  std::vector<std::uint8_t> moves;
+
+public:
+  PolicyWriter(std::FILE *file, const Rules &rules)
+      : rules(rules), writer(file, {rules}) {}
+
+  void operator()(std::size_t s, const std::vector<Key> &toPlace,
+                  const std::vector<Value> &placeValues,
+                  const std::vector<Key> &toMove,
+                  const std::vector<Value> &) {
+    const auto nextPlace = [&](Key state) {
+      if (rules.isTerminal(state))
+        return rules.terminalValue();
+      state = Shape::getUniqueState(state);
+      return placeValues[std::lower_bound(toPlace.begin(), toPlace.end(),
+                                          state) -
+                         toPlace.begin()];
+    };
+    moves.resize(toMove.size());
+    for (std::size_t i = 0; i < toMove.size(); ++i) {
+      Value value;
+      moves[i] = getBestMove(rules, toMove[i], nextPlace, value);
+    }
+    writer(s, {}, {}, toMove, moves);
+  }
+
+  bool finish() { return writer.finish(); }
+};
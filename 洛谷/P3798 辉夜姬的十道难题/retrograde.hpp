@@ -0,0 +1,268 @@
+// 自底向上的逆推求解：不递归，也没有函数内的 static 表
+//
+// 移动不改变数字和，放一块会让数字和增加 2 或 4，所以按数字和分层：
+// 先从空局面正向枚举每层可达的局面，再从数字和最大的一层往下填值
+// 同一层里“先手移”只依赖同一层的“先手放”，“先手放”只依赖更高的层
+// 每层的局面是排好序的规范形（getUniqueState），值存在平行的数组里
+// 正向枚举单独是 enumerateLayers，perfect.hpp 的预处理也用它
+//
+// Rules 描述目标，需要提供：
+//   using Shape; using Key;         棋盘形状（shape.hpp）和它的键
+//   using Value;
+//   bool isTerminal(Key) const;     到达后不再展开，值为 terminalValue()
+//   Value terminalValue() const;
+//   template <class F> Value place(Key state, F next) const;
+//     先手放：next(放完的局面) 是“先手移”的值
+//   template <class F> Value move(Key state, F next) const;
+//     先手移：next(移完的局面) 是“先手放”的值
+// 答案是空局面上先连放两块，即 place(0, next)，next 给出“先手放”的值
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "instrument.hpp"
+#include "shape.hpp"
+
+// 把 [0, count) 均分成若干段，f(段号, l, r) 在各自的线程里跑
+template <class F>
+void parallelFor(std::size_t count, unsigned threadCnt, F f) {
+  if (threadCnt <= 1 || count < 4096) {
+    f(0U, std::size_t(0), count);
+    return;
+  }
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < threadCnt; ++t)
+    threads.emplace_back(f, t, count * t / threadCnt,
+                         count * (t + 1) / threadCnt);
+  for (std::thread &thread : threads)
+    thread.join();
+}
+
+template <class Key> void normalizeStates(std::vector<Key> &states) {
+  std::sort(states.begin(), states.end());
+  states.erase(std::unique(states.begin(), states.end()), states.end());
+  states.shrink_to_fit();
+}
+
+// 各线程把结果分别放进 parts[段号][k]，最后依次并入 out[k]
+template <std::size_t K, class Key, class F>
+void expandStates(const std::vector<Key> &states, std::vector<Key> *out[K],
+                  unsigned threadCnt, F f) {
+  std::vector<std::vector<std::vector<Key>>> parts(
+      threadCnt, std::vector<std::vector<Key>>(K));
+  parallelFor(states.size(), threadCnt,
+              [&](unsigned t, std::size_t l, std::size_t r) {
+                for (std::size_t i = l; i < r; ++i)
+                  f(states[i], parts[t]);
+              });
+  for (auto &part : parts) {
+    for (std::size_t k = 0; k < K; ++k) {
+      out[k]->insert(out[k]->end(), part[k].begin(), part[k].end());
+      std::vector<Key>().swap(part[k]);
+    }
+  }
+}
+
+// 从空局面正向枚举每层可达的规范形，同时只留着相邻的三层
+// 第 s 层的“先手移”在处理 s - 1、s - 2 层时已经收齐；
+// 第 s 层收齐、孩子也展开之后调用 onLayer(s, toPlace, toMove)，
+// 两个 vector 排好序、去了重，回调可以直接拿走
+template <class Rules, class F>
+void enumerateLayers(const Rules &rules, unsigned threadCnt, F onLayer) {
+  using Shape = typename Rules::Shape;
+  using Key = typename Rules::Key;
+  std::vector<Key> toPlace[3], toMove[3]; // 第 s 层在下标 s % 3
+  for (unsigned i = 0; i < Shape::CELLS; ++i) {
+    for (unsigned v : {1, 2}) {
+      const Key state = Shape::place(0, i, v);
+      if (!rules.isTerminal(state))
+        toPlace[v].push_back(Shape::getUniqueState(state));
+    }
+  }
+  std::size_t end = 3; // 第 end 层及以上还没有局面
+  for (std::size_t s = 1; s < end; ++s) {
+    const auto start = instrument::now();
+    std::vector<Key> &place = toPlace[s % 3], &move = toMove[s % 3];
+    normalizeStates(move);
+    {
+      std::vector<Key> *out[1] = {&place};
+      expandStates<1>(move, out, threadCnt,
+                      [&](Key state, std::vector<std::vector<Key>> &part) {
+                        for (unsigned d = 0; d < 4; ++d) {
+                          const typename Shape::Move p = Shape::move(d, state);
+                          if (p.board != state && !rules.isTerminal(p.board))
+                            part[0].push_back(Shape::getUniqueState(p.board));
+                        }
+                      });
+    }
+    normalizeStates(place);
+    if (!place.empty()) {
+      end = std::max(end, s + 3);
+      std::vector<Key> *out[2] = {&toMove[(s + 1) % 3], &toMove[(s + 2) % 3]};
+      expandStates<2>(place, out, threadCnt,
+                      [&](Key state, std::vector<std::vector<Key>> &part) {
+                        for (unsigned i = 0; i < Shape::CELLS; ++i) {
+                          if (Shape::getCell(state, i))
+                            continue;
+                          for (unsigned v : {1, 2}) {
+                            const Key next = Shape::place(state, i, v);
+                            if (!rules.isTerminal(next))
+                              part[v - 1].push_back(
+                                  Shape::getUniqueState(next));
+                          }
+                        }
+                      });
+      // 相同的局面会从很多父亲来，先去一次重，免得攒太多
+      normalizeStates(toMove[(s + 1) % 3]);
+    }
+    instrument::recordLayer(instrument::ENUMERATE, s, start);
+    onLayer(s, place, move);
+    place = {};
+    move = {};
+  }
+}
+
+template <class Rules> class RetrogradeSolver {
+public:
+  using Shape = typename Rules::Shape;
+  using Key = typename Rules::Key;
+  using Value = typename Rules::Value;
+
+  // 规模统计，给调用者汇报用
+  struct Stats {
+    std::size_t layerCnt = 0;
+    std::size_t placeStates = 0, moveStates = 0;
+  };
+
+private:
+  struct Layer {
+    std::vector<Key> toPlace, toMove; // 先手放 / 先手移
+    std::vector<Value> placeValues, moveValues;
+  };
+
+  Rules rules;
+  unsigned threadCnt;
+  std::vector<Layer> layers; // 下标是数字和的一半
+  Stats stats;
+  [[no_unique_address]] instrument::MemoryGauge gauge;
+
+  // 各层数组的总大小，只在开了 SOLVER_STATS 时算
+  void measure() {
+    if constexpr (instrument::ENABLED) {
+      std::size_t bytes = 0;
+      for (const Layer &layer : layers)
+        bytes += (layer.toPlace.capacity() + layer.toMove.capacity()) *
+                     sizeof(Key) +
+                 (layer.placeValues.capacity() + layer.moveValues.capacity()) *
+                     sizeof(Value);
+      gauge.set(bytes);
+    }
+  }
+
+  static std::size_t find(const std::vector<Key> &states, Key state) {
+    return std::lower_bound(states.begin(), states.end(), state) -
+           states.begin();
+  }
+
+  void enumerate() {
+    layers.clear();
+    enumerateLayers(rules, threadCnt,
+                    [this](std::size_t s, std::vector<Key> &toPlace,
+                           std::vector<Key> &toMove) {
+                      if (layers.size() <= s)
+                        layers.resize(s + 1);
+                      layers[s].toPlace = std::move(toPlace);
+                      layers[s].toMove = std::move(toMove);
+                      measure();
+                    });
+    for (const Layer &layer : layers) {
+      stats.placeStates += layer.toPlace.size();
+      stats.moveStates += layer.toMove.size();
+    }
+    instrument::count(instrument::STATES,
+                      stats.placeStates + stats.moveStates);
+    while (!layers.empty() && layers.back().toPlace.empty() &&
+           layers.back().toMove.empty())
+      layers.pop_back();
+    stats.layerCnt = layers.size();
+  }
+
+  Value placeValue(Key state) const {
+    if (rules.isTerminal(state))
+      return rules.terminalValue();
+    state = Shape::getUniqueState(state);
+    const Layer &layer = layers[Shape::getLayer(state)];
+    instrument::count(instrument::MEMO_LOOKUPS);
+    instrument::count(instrument::MEMO_HITS);
+    return layer.placeValues[find(layer.toPlace, state)];
+  }
+
+  Value moveValue(Key state) const {
+    if (rules.isTerminal(state))
+      return rules.terminalValue();
+    state = Shape::getUniqueState(state);
+    const Layer &layer = layers[Shape::getLayer(state)];
+    instrument::count(instrument::MEMO_LOOKUPS);
+    instrument::count(instrument::MEMO_HITS);
+    return layer.moveValues[find(layer.toMove, state)];
+  }
+
+public:
+  explicit RetrogradeSolver(Rules rules = {},
+                            unsigned threadCnt = std::max(
+                                1U, std::thread::hardware_concurrency()))
+      : rules(rules), threadCnt(std::max(1U, threadCnt)) {}
+
+  // 枚举并填好所有层，返回空局面的答案
+  // 第 s 层用完之后，s + 2 层就不会再被用到，随手释放
+  // 每填好一层调用 onLayer(s, toPlace, placeValues, toMove, moveValues)，
+  // 从最高层往下依次调用，可以趁还没释放时把这一层存下来
+  template <class F> Value solve(F onLayer) {
+    enumerate();
+    const auto nextPlace = [this](Key state) { return placeValue(state); };
+    const auto nextMove = [this](Key state) { return moveValue(state); };
+    for (std::size_t s = layers.size(); s-- > 1;) {
+      const auto start = instrument::now();
+      Layer &layer = layers[s];
+      instrument::count(instrument::PLACE_CALLS, layer.toPlace.size());
+      instrument::count(instrument::MOVE_CALLS, layer.toMove.size());
+      layer.placeValues.resize(layer.toPlace.size());
+      parallelFor(layer.toPlace.size(), threadCnt,
+                  [&](unsigned, std::size_t l, std::size_t r) {
+                    for (std::size_t i = l; i < r; ++i)
+                      layer.placeValues[i] =
+                          rules.place(layer.toPlace[i], nextMove);
+                  });
+      layer.moveValues.resize(layer.toMove.size());
+      parallelFor(layer.toMove.size(), threadCnt,
+                  [&](unsigned, std::size_t l, std::size_t r) {
+                    for (std::size_t i = l; i < r; ++i)
+                      layer.moveValues[i] =
+                          rules.move(layer.toMove[i], nextPlace);
+                  });
+      measure();
+      onLayer(s, layer.toPlace, layer.placeValues, layer.toMove,
+              layer.moveValues);
+      if (s + 2 < layers.size())
+        layers[s + 2] = {};
+      measure();
+      instrument::recordLayer(instrument::SOLVE, s, start);
+    }
+    const Value answer = rules.place(Key(0), nextPlace);
+    layers.clear();
+    measure();
+    return answer;
+  }
+
+  Value solve() {
+    return solve([](std::size_t, const std::vector<Key> &,
+                    const std::vector<Value> &, const std::vector<Key> &,
+                    const std::vector<Value> &) {});
+  }
+
+  const Stats &getStats() const { return stats; }
+};
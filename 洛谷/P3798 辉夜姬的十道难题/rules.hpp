@@ -0,0 +1,210 @@
+// 三道题的目标，都按 retrograde.hpp 里 Rules 的约定写
+// 值是标量的几个另外提供 afterMove，给 query.hpp 找最优方向用
+// 放的方式（最小化 / 随机）、移的方式（最大化）、终止条件、得分各自独立，
+// 求解器、记忆化表和移动都是共用的
+// 每个目标都是 Basic* 模板，按棋盘形状（shape.hpp）实例化，
+// 不带前缀的名字是题目里的 3x3
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <string>
+
+#include "shape.hpp"
+
+namespace rules {
+
+// 放：对手挑最坏的格子和数字
+template <class S, class Value, class F>
+Value placeMin(typename S::Key state, F next) {
+  Value answer = std::numeric_limits<Value>::max();
+  for (unsigned i = 0; i < S::CELLS; ++i) {
+    if (S::getCell(state, i))
+      continue;
+    answer = std::min(answer, next(S::place(state, i, 1)));
+    answer = std::min(answer, next(S::place(state, i, 2)));
+  }
+  return answer;
+}
+
+// 放：空格等概率，2 和 4 的概率是 0.9 和 0.1
+template <class S, class Value, class F>
+Value placeRandom(typename S::Key state, F next) {
+  Value answer{};
+  unsigned short cnt = 0;
+  for (unsigned i = 0; i < S::CELLS; ++i) {
+    if (S::getCell(state, i))
+      continue;
+    ++cnt;
+    answer += next(S::place(state, i, 1)) * 0.9;
+    answer += next(S::place(state, i, 2)) * 0.1;
+  }
+  return answer / cnt;
+}
+
+// 走了 p 之后的值；SCORE 决定是否计入这一步的合并得分
+template <bool SCORE, class Value, class MoveT, class F>
+Value afterMove(const MoveT &p, F next) {
+  if constexpr (SCORE)
+    return p.score + next(p.board);
+  else
+    return next(p.board);
+}
+
+// 移：挑最好的方向
+template <class S, bool SCORE, class Value, class F>
+Value moveMax(typename S::Key state, F next) {
+  Value answer = 0;
+  for (unsigned d = 0; d < 4; ++d) {
+    const typename S::Move p = S::move(d, state);
+    if (p.board == state)
+      continue;
+    answer = std::max(answer, afterMove<SCORE, Value>(p, next));
+  }
+  return answer;
+}
+
+} // namespace rules
+
+// 7：放的一方最小化，移的一方最大化总得分
+template <class S> struct BasicMinPlacementScore {
+  using Shape = S;
+  using Key = typename S::Key;
+  using Value = unsigned long;
+
+  std::string describe() const { return "MinPlacementScore " + S::name(); }
+  bool isTerminal(Key) const { return false; }
+  Value terminalValue() const { return 0; }
+
+  template <class F> Value place(Key state, F next) const {
+    return rules::placeMin<S, Value>(state, next);
+  }
+
+  template <class F> Value move(Key state, F next) const {
+    return rules::moveMax<S, true, Value>(state, next);
+  }
+
+  template <class F>
+  Value afterMove(const typename S::Move &p, F next) const {
+    return rules::afterMove<true, Value>(p, next);
+  }
+};
+
+// 8：随机放，最大化合出 2^target 的概率
+template <class S> struct BasicReachProbability {
+  using Shape = S;
+  using Key = typename S::Key;
+  using Value = double;
+
+  unsigned target;
+
+  std::string describe() const {
+    return "ReachProbability " + S::name() + " " + std::to_string(target);
+  }
+  bool isTerminal(Key state) const { return S::getMax(state) >= target; }
+  Value terminalValue() const { return 1; }
+
+  template <class F> Value place(Key state, F next) const {
+    return rules::placeRandom<S, Value>(state, next);
+  }
+
+  template <class F> Value move(Key state, F next) const {
+    return rules::moveMax<S, false, Value>(state, next);
+  }
+
+  template <class F>
+  Value afterMove(const typename S::Move &p, F next) const {
+    return rules::afterMove<false, Value>(p, next);
+  }
+};
+
+// 9：随机放，最大化总得分的期望
+template <class S> struct BasicExpectedScore {
+  using Shape = S;
+  using Key = typename S::Key;
+  using Value = double;
+
+  std::string describe() const { return "ExpectedScore " + S::name(); }
+  bool isTerminal(Key) const { return false; }
+  Value terminalValue() const { return 0; }
+
+  template <class F> Value place(Key state, F next) const {
+    return rules::placeRandom<S, Value>(state, next);
+  }
+
+  template <class F> Value move(Key state, F next) const {
+    return rules::moveMax<S, true, Value>(state, next);
+  }
+
+  template <class F>
+  Value afterMove(const typename S::Move &p, F next) const {
+    return rules::afterMove<true, Value>(p, next);
+  }
+};
+
+// 8 的所有 target 一起算：第 t 个分量是合出 2^t 的概率
+// 每个分量各自取最优的移动，和分别跑 ReachProbability{t} 的结果一样
+// 不再有终止局面，已经合出 2^t 的局面把第 t 个分量钉成 1
+template <class S> struct BasicReachDistribution {
+  using Shape = S;
+  using Key = typename S::Key;
+
+  // n 格的数字和不超过 2^(n + 2) - 4，合不出 2^(n + 2)；3x3 是 11
+  static constexpr unsigned MAX_TARGET = S::CELLS + 2;
+
+  struct Value {
+    std::array<double, MAX_TARGET + 1> p{}; // p[0] 不用
+
+    Value &operator+=(const Value &other) {
+      for (unsigned t = 1; t <= MAX_TARGET; ++t)
+        p[t] += other.p[t];
+      return *this;
+    }
+
+    friend Value operator*(Value value, double k) {
+      for (unsigned t = 1; t <= MAX_TARGET; ++t)
+        value.p[t] *= k;
+      return value;
+    }
+
+    friend Value operator/(Value value, unsigned short k) {
+      for (unsigned t = 1; t <= MAX_TARGET; ++t)
+        value.p[t] /= k;
+      return value;
+    }
+  };
+
+  static Value reached(Key state, Value value) {
+    for (unsigned t = 1; t <= std::min(S::getMax(state), MAX_TARGET); ++t)
+      value.p[t] = 1;
+    return value;
+  }
+
+  std::string describe() const { return "ReachDistribution " + S::name(); }
+  bool isTerminal(Key) const { return false; }
+  Value terminalValue() const { return {}; }
+
+  template <class F> Value place(Key state, F next) const {
+    return reached(state, rules::placeRandom<S, Value>(state, next));
+  }
+
+  template <class F> Value move(Key state, F next) const {
+    Value answer;
+    for (unsigned d = 0; d < 4; ++d) {
+      const typename S::Move p = S::move(d, state);
+      if (p.board == state)
+        continue;
+      const Value value = next(p.board);
+      for (unsigned t = 1; t <= MAX_TARGET; ++t)
+        answer.p[t] = std::max(answer.p[t], value.p[t]);
+    }
+    return reached(state, answer);
+  }
+};
+
+using MinPlacementScore = BasicMinPlacementScore<Shape<3, 3>>;
+using ReachProbability = BasicReachProbability<Shape<3, 3>>;
+using ExpectedScore = BasicExpectedScore<Shape<3, 3>>;
+using ReachDistribution = BasicReachDistribution<Shape<3, 3>>;
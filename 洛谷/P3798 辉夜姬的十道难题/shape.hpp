@@ -0,0 +1,233 @@
+// 棋盘形状：N 行 M 列，求解器、目标和记忆化表都按 Shape 实例化
+// 每格 BITS 位（默认 5），(i, j) 在第 BITS * (M * i + j) 位起，
+// 第 i 行是连续的 BITS * M 位
+// 总共不超过 64 位时键是 64 位整数，否则是 128 位
+// Shape<4, 4, 4> 是常见的 4x4 位棋盘：64 位，指数最大 15，行表 2^16 项
+// 3x3 特化成 board.hpp 里手写的查表和位运算，别的形状用通用的写法
+//
+// Shape 提供：
+//   using Key; using Move;     Move 是 {Key board; std::uint32_t score}
+//   CELLS、SYMMETRIES          格数，对称数（正方形 8 个，长方形 4 个）
+//   CELL_WIDTH                 每格的位数
+//   getRow(key, i)、getColumn(key, j)  一行 / 一列压成的整数
+//   name()                     "NxM"，每格不是 5 位时再加 "/BITS"
+//   getCell(key, pos)、place(key, pos, v)、getMax(key)、getLayer(key)
+//   getUniqueState(key)        所有对称里最小的表示
+//   move(d, key)               d 的顺序和 MOVES 一样：上、下、左、右
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "board.hpp"
+
+template <class Key> struct ShapeMove {
+  Key board;
+  std::uint32_t score;
+};
+
+// 长为 L、每格 CELL 位的一行的滑动表，运行时建一次
+// L = 4 时每格 5 位有 2^20 项，4 位有 2^16 项
+template <unsigned L, unsigned CELL = CELL_BITS> struct LineKernel {
+  static constexpr unsigned BITS = CELL * L;
+  static constexpr unsigned MASK = (1U << BITS) - 1;
+
+  struct Entry {
+    std::uint32_t line;
+    std::uint32_t score;
+  };
+
+  static std::vector<Entry> makeTable() {
+    std::vector<Entry> table(std::size_t(1) << BITS);
+    for (unsigned line = 0; line < table.size(); ++line) {
+      unsigned score = 0;
+      const unsigned result = slideLine<CELL>(line, L, score);
+      table[line] = {result, score};
+    }
+    return table;
+  }
+
+  inline static const std::vector<Entry> TABLE = makeTable();
+
+  static constexpr unsigned reverse(unsigned line) {
+    unsigned result = 0;
+    for (unsigned i = 0; i < L; ++i)
+      result |= (line >> (CELL * i) & ((1U << CELL) - 1))
+                << (CELL * (L - 1 - i));
+    return result;
+  }
+};
+
+template <unsigned N, unsigned M, unsigned BITS = CELL_BITS> struct Shape {
+  static_assert(N >= 2 && M >= 2 && N <= 4 && M <= 4);
+  static_assert(BITS == 4 || BITS == 5);
+
+  static constexpr unsigned ROWS = N, COLUMNS = M, CELLS = N * M;
+  static constexpr unsigned SYMMETRIES = N == M ? 8 : 4;
+  static constexpr unsigned CELL_WIDTH = BITS;
+  static constexpr unsigned MASK = (1U << BITS) - 1;
+  using Key = std::conditional_t<CELLS * BITS <= 64, std::uint64_t,
+                                 unsigned __int128>;
+  using Move = ShapeMove<Key>;
+  using Row = LineKernel<M, BITS>;
+  using Column = LineKernel<N, BITS>;
+
+  static std::string name() {
+    std::string name = std::to_string(N) + "x" + std::to_string(M);
+    if (BITS != CELL_BITS)
+      name += "/" + std::to_string(BITS);
+    return name;
+  }
+
+  static constexpr unsigned getCell(Key key, unsigned pos) {
+    return static_cast<unsigned>(key >> (BITS * pos)) & MASK;
+  }
+
+  static constexpr Key place(Key key, unsigned pos, unsigned v) {
+    return key | Key(v) << (BITS * pos);
+  }
+
+  static constexpr unsigned getMax(Key key) {
+    unsigned answer = 0;
+    for (unsigned i = 0; i < CELLS; ++i)
+      answer = std::max(answer, getCell(key, i));
+    return answer;
+  }
+
+  static constexpr unsigned getLayer(Key key) {
+    unsigned sum = 0;
+    for (unsigned i = 0; i < CELLS; ++i) {
+      if (getCell(key, i))
+        sum += 1U << (getCell(key, i) - 1);
+    }
+    return sum;
+  }
+
+  // 逐格搬：(i, j) 搬到 f(i, j)
+  template <class F> static constexpr Key permute(Key key, F f) {
+    Key result = 0;
+    for (unsigned i = 0; i < N; ++i) {
+      for (unsigned j = 0; j < M; ++j)
+        result |= Key(getCell(key, M * i + j)) << (BITS * f(i, j));
+    }
+    return result;
+  }
+
+  static constexpr Key mirrorHorizontally(Key key) {
+    return permute(key,
+                   [](unsigned i, unsigned j) { return M * i + M - 1 - j; });
+  }
+
+  static constexpr Key mirrorVertically(Key key) {
+    return permute(key,
+                   [](unsigned i, unsigned j) { return M * (N - 1 - i) + j; });
+  }
+
+  // 只有正方形才有；长方形的对称只有两个镜像和它们的复合
+  static constexpr Key transpose(Key key) {
+    static_assert(N == M);
+    return permute(key, [](unsigned i, unsigned j) { return M * j + i; });
+  }
+
+  static constexpr Key getUniqueState(Key key) {
+    const Key h = mirrorHorizontally(key);
+    Key answer = std::min({key, h, mirrorVertically(key), mirrorVertically(h)});
+    if constexpr (N == M) {
+      const Key t = transpose(key);
+      const Key th = mirrorHorizontally(t);
+      answer = std::min({answer, t, th, mirrorVertically(t),
+                         mirrorVertically(th)});
+    }
+    return answer;
+  }
+
+  static unsigned getRow(Key key, unsigned i) {
+    return static_cast<unsigned>(key >> (Row::BITS * i)) & Row::MASK;
+  }
+
+  static unsigned getColumn(Key key, unsigned j) {
+    unsigned line = 0;
+    for (unsigned i = 0; i < N; ++i)
+      line |= getCell(key, M * i + j) << (BITS * i);
+    return line;
+  }
+
+  static Key spreadColumn(unsigned line, unsigned j) {
+    Key key = 0;
+    for (unsigned i = 0; i < N; ++i)
+      key |= Key(line >> (BITS * i) & MASK) << (BITS * (M * i + j));
+    return key;
+  }
+
+  static Move move(unsigned d, Key key) {
+    Move p{0, 0};
+    if (d < 2) {
+      for (unsigned j = 0; j < M; ++j) {
+        const unsigned line = getColumn(key, j);
+        const auto &e = Column::TABLE[d ? Column::reverse(line) : line];
+        p.board |= spreadColumn(d ? Column::reverse(e.line) : e.line, j);
+        p.score += e.score;
+      }
+    } else {
+      for (unsigned i = 0; i < N; ++i) {
+        const unsigned line = getRow(key, i);
+        const auto &e = Row::TABLE[d == 3 ? Row::reverse(line) : line];
+        p.board |= Key(d == 3 ? Row::reverse(e.line) : e.line)
+                   << (Row::BITS * i);
+        p.score += e.score;
+      }
+    }
+    return p;
+  }
+};
+
+// 3x3 直接用 board.hpp 手写的版本
+template <> struct Shape<3, 3> {
+  static constexpr unsigned ROWS = 3, COLUMNS = 3, CELLS = 9;
+  static constexpr unsigned SYMMETRIES = 8;
+  static constexpr unsigned CELL_WIDTH = CELL_BITS;
+  using Key = Board;
+  using Move = ::Move;
+
+  static std::string name() { return "3x3"; }
+
+  static constexpr unsigned getCell(Key key, unsigned pos) {
+    return ::getCell(key, pos);
+  }
+
+  static constexpr Key place(Key key, unsigned pos, unsigned v) {
+    return key | Key(v) << (CELL_BITS * pos);
+  }
+
+  static constexpr unsigned getMax(Key key) { return ::getMax(key); }
+  static constexpr unsigned getLayer(Key key) { return ::getLayer(key); }
+
+  static constexpr Key getUniqueState(Key key) {
+    return ::getUniqueState(key);
+  }
+
+  static constexpr unsigned getRow(Key key, unsigned i) {
+    return ::getRow(key, i);
+  }
+
+  static constexpr unsigned getColumn(Key key, unsigned j) {
+    return ::getColumn(key, j);
+  }
+
+  static constexpr Move move(unsigned d, Key key) {
+    switch (d) {
+    case 0:
+      return moveUpwards(key);
+    case 1:
+      return moveDownwards(key);
+    case 2:
+      return moveLeft(key);
+    default:
+      return moveRight(key);
+    }
+  }
+};
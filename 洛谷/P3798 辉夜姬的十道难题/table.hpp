@@ -0,0 +1,239 @@
+// 逆推结果的持久化：每层排好序的规范形和对应的值原样写进文件，
+// 之后 mmap 进来直接二分查找，不需要解析（POSIX）
+//
+// 布局，各段按 8 字节对齐：
+//   TableHeader
+//   从最高层往下，每层依次是 先手放的键、值，先手移的键、值
+//   TableLayer[layerCnt]，下标是数字和的一半
+// 值按内存原样存储，只能在同一种机器上读回
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "shape.hpp"
+
+struct TableHeader {
+  char magic[8]; // "P3798TBL"
+  std::uint32_t version;
+  std::uint32_t valueSize;
+  char rules[48]; // Rules::describe()，防止拿错文件
+  std::uint64_t layerCnt;
+  std::uint64_t layersOffset;
+  std::uint64_t size; // 文件总长
+};
+
+struct TableLayer {
+  std::uint64_t placeCnt, moveCnt;
+  std::uint64_t placeKeys, placeValues, moveKeys, moveValues; // 偏移
+};
+
+constexpr char TABLE_MAGIC[8] = {'P', '3', '7', '9', '8', 'T', 'B', 'L'};
+constexpr std::uint32_t TABLE_VERSION = 1;
+
+// 作为 RetrogradeSolver::solve 的回调，每填好一层就写一层
+template <class Rules> class TableWriter {
+public:
+  using Key = typename Rules::Key;
+  using Value = typename Rules::Value;
+  static_assert(std::is_trivially_copyable_v<Key> &&
+                std::is_trivially_copyable_v<Value>);
+
+private:
+  std::FILE *file;
+  TableHeader header{};
+  std::vector<TableLayer> layers;
+  std::uint64_t offset = 0;
+  bool ok = true;
+
+  std::uint64_t write(const void *data, std::size_t size) {
+    static constexpr char PADDING[8] = {};
+    const std::uint64_t start = offset;
+    ok = ok && std::fwrite(data, 1, size, file) == size;
+    offset += size;
+    const std::size_t padding = (8 - offset % 8) % 8;
+    ok = ok && std::fwrite(PADDING, 1, padding, file) == padding;
+    offset += padding;
+    return start;
+  }
+
+public:
+  TableWriter(std::FILE *file, const Rules &rules) : file(file) {
+    std::memcpy(header.magic, TABLE_MAGIC, sizeof(header.magic));
+    header.version = TABLE_VERSION;
+    header.valueSize = sizeof(Value);
+    const std::string name = rules.describe();
+    std::strncpy(header.rules, name.c_str(), sizeof(header.rules) - 1);
+    write(&header, sizeof(header)); // 先占位，finish 时回填
+  }
+
+  void operator()(std::size_t s, const std::vector<Key> &toPlace,
+                  const std::vector<Value> &placeValues,
+                  const std::vector<Key> &toMove,
+                  const std::vector<Value> &moveValues) {
+    if (layers.size() <= s)
+      layers.resize(s + 1);
+    TableLayer &layer = layers[s];
+    layer.placeCnt = toPlace.size();
+    layer.moveCnt = toMove.size();
+    layer.placeKeys = write(toPlace.data(), toPlace.size() * sizeof(Key));
+    layer.placeValues =
+        write(placeValues.data(), placeValues.size() * sizeof(Value));
+    layer.moveKeys = write(toMove.data(), toMove.size() * sizeof(Key));
+    layer.moveValues =
+        write(moveValues.data(), moveValues.size() * sizeof(Value));
+  }
+
+  bool finish() {
+    header.layerCnt = layers.size();
+    header.layersOffset =
+        write(layers.data(), layers.size() * sizeof(TableLayer));
+    header.size = offset;
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0 &&
+         std::fwrite(&header, sizeof(header), 1, file) == 1;
+    return ok;
+  }
+};
+
+template <class Rules> class MappedTable {
+public:
+  using Shape = typename Rules::Shape;
+  using Key = typename Rules::Key;
+  using Value = typename Rules::Value;
+
+private:
+  Rules rules;
+  void *data = MAP_FAILED;
+  std::size_t size = 0;
+  const TableHeader *header = nullptr;
+  const TableLayer *layers = nullptr;
+
+  template <class T> const T *at(std::uint64_t offset) const {
+    return reinterpret_cast<const T *>(static_cast<const char *>(data) +
+                                       offset);
+  }
+
+  // 从 offset 起的 cnt 个 T 整个落在文件里，offset 按 8 字节对齐
+  template <class T> bool fits(std::uint64_t offset, std::uint64_t cnt) const {
+    return offset % 8 == 0 && offset <= size &&
+           cnt <= (size - offset) / sizeof(T);
+  }
+
+  // find() 要二分，每层的键必须严格递增
+  static bool isIncreasing(const Key *keys, std::uint64_t cnt) {
+    return std::adjacent_find(keys, keys + cnt, [](Key a, Key b) {
+             return !(a < b);
+           }) == keys + cnt;
+  }
+
+  // 头部和每一层的偏移、长度都要检查，坏文件不能让 at() 读出映射；
+  // 键的顺序也要检查，这一遍会把键全读一次
+  bool validate() const {
+    if (size < sizeof(TableHeader))
+      return false;
+    const TableHeader &h = *at<TableHeader>(0);
+    if (std::memcmp(h.magic, TABLE_MAGIC, sizeof(h.magic)) ||
+        h.version != TABLE_VERSION || h.valueSize != sizeof(Value) ||
+        h.size != size || !std::memchr(h.rules, 0, sizeof(h.rules)) ||
+        rules.describe() != h.rules)
+      return false;
+    if (!fits<TableLayer>(h.layersOffset, h.layerCnt))
+      return false;
+    const TableLayer *l = at<TableLayer>(h.layersOffset);
+    for (std::uint64_t s = 0; s < h.layerCnt; ++s) {
+      if (!fits<Key>(l[s].placeKeys, l[s].placeCnt) ||
+          !fits<Value>(l[s].placeValues, l[s].placeCnt) ||
+          !fits<Key>(l[s].moveKeys, l[s].moveCnt) ||
+          !fits<Value>(l[s].moveValues, l[s].moveCnt) ||
+          !isIncreasing(at<Key>(l[s].placeKeys), l[s].placeCnt) ||
+          !isIncreasing(at<Key>(l[s].moveKeys), l[s].moveCnt))
+        return false;
+    }
+    return true;
+  }
+
+  // 在排好序的 keys 里找 state，找不到返回 nullptr
+  static const Value *find(const Key *keys, const Value *values,
+                           std::uint64_t cnt, Key state) {
+    const Key *p = std::lower_bound(keys, keys + cnt, state);
+    return p != keys + cnt && *p == state ? values + (p - keys) : nullptr;
+  }
+
+  template <bool PLACE> bool lookup(Key state, Value &value) const {
+    if (rules.isTerminal(state)) {
+      value = rules.terminalValue();
+      return true;
+    }
+    state = Shape::getUniqueState(state);
+    const std::size_t s = Shape::getLayer(state);
+    if (s >= header->layerCnt)
+      return false;
+    const TableLayer &layer = layers[s];
+    const Value *p =
+        PLACE ? find(at<Key>(layer.placeKeys), at<Value>(layer.placeValues),
+                     layer.placeCnt, state)
+              : find(at<Key>(layer.moveKeys), at<Value>(layer.moveValues),
+                     layer.moveCnt, state);
+    if (!p)
+      return false;
+    value = *p;
+    return true;
+  }
+
+public:
+  MappedTable(const char *path, const Rules &rules = {}) : rules(rules) {
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      size = st.st_size;
+      data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED || !validate())
+      return;
+    header = at<TableHeader>(0);
+    layers = at<TableLayer>(header->layersOffset);
+  }
+
+  MappedTable(const MappedTable &) = delete;
+  MappedTable &operator=(const MappedTable &) = delete;
+
+  ~MappedTable() {
+    if (data != MAP_FAILED)
+      munmap(data, size);
+  }
+
+  bool isOpen() const { return header != nullptr; }
+
+  // 先手放 / 先手移的值，写进 value；不可达的局面返回 false
+  // 终止局面不在表里，由 Rules 直接给出，所以只能返回拷贝
+  bool findPlace(Key state, Value &value) const {
+    return lookup<true>(state, value);
+  }
+
+  bool findMove(Key state, Value &value) const {
+    return lookup<false>(state, value);
+  }
+
+  // 空局面的答案：连放两块
+  Value answer() const {
+    return rules.place(Key(0), [this](Key state) {
+      Value value{};
+      findPlace(state, value);
+      return value;
+    });
+  }
+};
@@ -0,0 +1,63 @@
+// 三道题换成别的棋盘形状
+// 用法：./variants NxM 7 [threads]
+//       ./variants NxM 8 target [threads]
+//       ./variants NxM 9 [threads]
+// NxM 是 2x2、2x3、2x4、3x3、3x4、4x4 或者转置过来的 3x2、4x2、4x3，
+// N 行 M 列；转置的形状答案不变，可以拿来对照
+// target 在 1 到 N * M + 2 之间，threads 是正整数，不合法时输出用法
+// 穷举只对小棋盘可行，4x4 只算得动很小的 target（比如 8 3）
+// 答案输出到标准输出，局面数输出到标准错误
+// 用 -DSOLVER_STATS 编译时另外输出计数器的报告（见 instrument.hpp）
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "cli.hpp"
+#include "instrument.hpp"
+#include "retrograde.hpp"
+#include "rules.hpp"
+
+template <class Rules> void run(const Rules &rules, unsigned threadCnt) {
+  const instrument::ReportOnExit report;
+  RetrogradeSolver<Rules> solver(rules, threadCnt);
+  std::cout << std::fixed << std::setprecision(10) << solver.solve() << '\n';
+  const auto &stats = solver.getStats();
+  std::cerr << rules.describe() << ": " << stats.layerCnt << " layers, "
+            << stats.placeStates << " + " << stats.moveStates << " states\n";
+}
+
+template <class S> int runShape(int argc, char **argv) {
+  const char *problem = argv[2];
+  int next = 3;
+  unsigned target = 0;
+  if (!std::strcmp(problem, "8") &&
+      (argc <= next || !parseTarget<S>(argv[next++], target)))
+    return -1;
+  unsigned threadCnt = std::thread::hardware_concurrency();
+  if (argc > next && !parsePositive(argv[next], threadCnt))
+    return -1;
+  if (!std::strcmp(problem, "7"))
+    run(BasicMinPlacementScore<S>{}, threadCnt);
+  else if (!std::strcmp(problem, "8"))
+    run(BasicReachProbability<S>{target}, threadCnt);
+  else if (!std::strcmp(problem, "9"))
+    run(BasicExpectedScore<S>{}, threadCnt);
+  else
+    return -1;
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  int result = -1;
+  if (argc >= 3)
+    result = dispatchShape(argv[1], [&](auto shape) {
+      return runShape<typename decltype(shape)::type>(argc, argv);
+    });
+  if (result < 0) {
+    std::cerr << "usage: " << argv[0] << " NxM 7|8 target|9 [threads]\n";
+    return 1;
+  }
+  return result;
+}